@@ -1,71 +1,161 @@
 #include "AStar.h"
 
-#include <unordered_set>
+#include "logging.h"
+#include "search_containers.h"
 
-struct AStarState {
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Search nodes live in a per-thread arena and point to their parents by index,
+// so expanding a state never copies the path that led to it
+struct AStarNode {
+  Point position;
+  size_t parent;
+};
+
+constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+
+thread_local size_t expanded_nodes = 0;
+
+std::vector<Point> RestorePath(const std::vector<AStarNode>& nodes, size_t node_idx) {
   std::vector<Point> path;
+  for (; node_idx != kNoParent; node_idx = nodes[node_idx].parent) {
+    path.push_back(nodes[node_idx].position);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+}
+
+struct AStarState {
+  size_t node_idx;
+  Point position;
   size_t label;
   size_t ts;
   std::optional<size_t> waiting_duration_opt;
 
-  size_t LowerBoundToGoal(const Point& goal) const {
-    ASSERT(!path.empty() && "error, path is empty!");
-    return std::abs(path.back().x - goal.x) + std::abs(path.back().y - goal.y);
+  size_t LowerBoundToGoal(const Point& goal, const DistanceTable& distances, const Graph& graph) const {
+    const uint32_t distance = distances[graph.GetCellIndex(position)];
+    if (distance == DistancesCache::kUnreachable) {
+      return std::abs(position.x - goal.x) + std::abs(position.y - goal.y);
+    }
+    return distance;
   }
-};
 
-struct AStarUsedState {
-  Point point;
-  size_t ts;
-  std::optional<size_t> waiting_duration_opt;
+  // Moves to next_position at the next timestep, counting checkpoint visits and waiting
+  void Step(const Point& next_position, const Agent& agent, const size_t time_to_wait) {
+    position = next_position;
+    if (waiting_duration_opt) {
+      if (waiting_duration_opt.value() + 1 >= time_to_wait) {
+        waiting_duration_opt = std::nullopt;
+      } else {
+        ++waiting_duration_opt.value();
+      }
+    } else if (position == agent.locations_to_visit[label]) {
+      ++label;
+      if (time_to_wait > 1) {
+        waiting_duration_opt = 1;
+      }
+    }
+    ++ts;
+  }
+
+  bool IsFinished(const Agent& agent, const size_t time_to_wait) const {
+    return label == agent.locations_to_visit.size() && (!waiting_duration_opt || time_to_wait <= 1);
+  }
 };
 
+#ifdef ASTAR_BINARY_HEAP_OPEN_LIST
+using AStarOpenList = BinaryHeapOpenList<AStarState>;
+#else
+using AStarOpenList = BucketOpenList<AStarState>;
+#endif
+
+namespace {
+
+// Continues the path beyond the planning horizon ignoring constraints and other agents:
+// the agent walks down the distance tables of its remaining locations. Returns false if
+// one of them is unreachable.
+bool AppendUnconstrainedRemainder(
+    std::vector<Point>& path,
+    AStarState state,
+    const Agent& agent,
+    const Graph& graph,
+    const std::vector<std::shared_ptr<const DistanceTable>>& goal_distances) {
+  const size_t time_to_wait = graph.GetTimeToWaitNearCheckpoints();
+  while (!state.IsFinished(agent, time_to_wait)) {
+    Point next_position = state.position;
+    if (!state.waiting_duration_opt) {
+      const auto& distances = *goal_distances[state.label];
+      const uint32_t distance = distances[graph.GetCellIndex(state.position)];
+      if (distance == DistancesCache::kUnreachable) {
+        return false;
+      }
+      for (const auto& neighbour : graph.GetNeighbours(state.position, false)) {
+        if (distances[graph.GetCellIndex(neighbour)] + 1 == distance) {
+          next_position = neighbour;
+          break;
+        }
+      }
+    }
+    state.Step(next_position, agent, time_to_wait);
+    path.push_back(state.position);
+  }
+  return true;
+}
+
+// Packs a visited (cell, ts, waiting duration) triple into a closed list key
+uint64_t UsedStateKey(
+    const size_t cell, const size_t ts, const std::optional<size_t>& waiting_duration_opt) {
+  const uint64_t waiting_code = waiting_duration_opt ? waiting_duration_opt.value() + 1 : 0;
+  return static_cast<uint64_t>(cell) | (static_cast<uint64_t>(ts) << 28) | (waiting_code << 52);
+}
+
+}
+
 std::vector<Point> AStar(
     const Agent& agent,
     const std::unordered_map<size_t, std::set<Point>>& vertex_conflicts,
     const std::unordered_map<size_t, std::set<Edge>>&  edge_conflicts,
     const Graph& graph,
-    const std::optional<std::reference_wrapper<const std::vector<std::vector<Point>>>> paths_opt,
-    const std::optional<std::reference_wrapper<const std::vector<size_t>>> topsort_order_opt,
-    const std::optional<size_t> agent_topsort_idx_opt) {
+    const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt,
+    const std::optional<size_t> horizon_opt) {
   if (agent.locations_to_visit.empty()) {
     return {};
   }
-  auto states_cmp = [&agent](const AStarState& s1, const AStarState& s2) {
-    if (s1.label < s2.label) {
-      return false;
-    } else if (s1.label > s2.label) {
-      return true;
-    } else {
-      return s1.ts + s1.LowerBoundToGoal(agent.locations_to_visit[s1.label])
-          < s2.ts + s2.LowerBoundToGoal(agent.locations_to_visit[s2.label]);
-    }
+  std::vector<std::shared_ptr<const DistanceTable>> goal_distances;
+  goal_distances.reserve(agent.locations_to_visit.size());
+  for (const auto& location : agent.locations_to_visit) {
+    goal_distances.push_back(graph.GetDistanceTable(location));
+  }
+  const auto lower_bound_to_goal = [&] (const AStarState& state) {
+    return state.LowerBoundToGoal(
+        agent.locations_to_visit[state.label], *goal_distances[state.label], graph);
   };
 
-  auto used_states_cmp = [](const AStarUsedState& s1, const AStarUsedState& s2) {
-    if (s1.ts < s2.ts) {
-      return false;
-    } else if (s1.ts > s2.ts) {
-      return true;
-    } else {
-      if (s1.point < s2.point) {
-        return false;
-      } else if (s1.point > s2.point) {
-        return true;
-      } else {
-        return s1.waiting_duration_opt < s2.waiting_duration_opt;
-      }
-    }
+  thread_local AStarOpenList states;
+  thread_local FlatHashSet used;
+  thread_local std::vector<AStarNode> nodes;
+  states.Clear();
+  used.Clear();
+  nodes.clear();
+
+  // States are ordered by label first and by estimated cost second
+  const auto push_state = [&] (AStarState state) {
+    const size_t label = state.label;
+    const size_t cost = state.ts + lower_bound_to_goal(state);
+    states.Push(std::move(state), label, cost);
   };
 
-  std::multiset<AStarState, decltype(states_cmp)> states(states_cmp);
-  std::set<AStarUsedState, decltype(used_states_cmp)> used(used_states_cmp);
-
   size_t start_ts = 0;
-  while (states.empty()) {
+  while (states.Empty()) {
     if (!vertex_conflicts.count(start_ts) || !vertex_conflicts.at(start_ts).count(agent.start)) {
-      states.insert({{agent.start}, 0, start_ts, agent.waiting_duration_opt});
-      used.insert({agent.start, 0, agent.waiting_duration_opt});
+      nodes.push_back({agent.start, kNoParent});
+      push_state({nodes.size() - 1, agent.start, 0, start_ts, agent.waiting_duration_opt});
+      used.Insert(UsedStateKey(graph.GetCellIndex(agent.start), 0, agent.waiting_duration_opt));
     }
     ++start_ts;
   }
@@ -79,7 +169,7 @@ std::vector<Point> AStar(
       // Need to wait at checkpoint
       return false;
     }
-    if (used.count({next_position, ts, waiting_duration_opt})) {
+    if (used.Contains(UsedStateKey(graph.GetCellIndex(next_position), ts, waiting_duration_opt))) {
       // State was visited earlier
       return false;
     }
@@ -91,74 +181,65 @@ std::vector<Point> AStar(
       // Forbidden by edge conflict
       return false;
     }
-    if (paths_opt && topsort_order_opt && agent_topsort_idx_opt) {
-      for (size_t i = 0; i < agent_topsort_idx_opt.value(); ++i) {
-        size_t agent_idx = topsort_order_opt->get()[i];
-        if (ts >= paths_opt->get()[agent_idx].size()) {
-          continue;
-        }
-        if (paths_opt->get()[agent_idx][ts] == next_position) {
-          // Has vertex conflict with higher priority agent
-          return false;
-        }
-        if (ts > 0) {
-          if (paths_opt->get()[agent_idx][ts] == position
-              && paths_opt->get()[agent_idx][ts - 1] == next_position) {
-            // Has edge conflict with higher priority agent
-            return false;
-          }
-        }
+    if (reservation_table_opt) {
+      if (reservation_table_opt->get().IsVertexReserved(next_position, ts)) {
+        // Has vertex conflict with higher priority agent
+        return false;
+      }
+      if (reservation_table_opt->get().IsEdgeReserved(position, next_position, ts)) {
+        // Has edge conflict with higher priority agent
+        return false;
       }
     }
     return true;
   };
 
-  while (!states.empty()) {
-    const AStarState cur_state = *(states.begin());
-
-    states.erase(states.begin());
-    const auto neighbours = graph.GetNeighbours(cur_state.path.back());
+  const size_t time_to_wait = graph.GetTimeToWaitNearCheckpoints();
+  while (!states.Empty()) {
+    const AStarState cur_state = states.Pop();
+    ++expanded_nodes;
+    const auto neighbours = graph.GetNeighbours(cur_state.position);
     const size_t ts = cur_state.ts;
 
+    if (horizon_opt && ts >= horizon_opt.value()) {
+      // Constraints are resolved up to the horizon, the rest of the path is a cheap estimate
+      auto path = RestorePath(nodes, cur_state.node_idx);
+      if (!AppendUnconstrainedRemainder(path, cur_state, agent, graph, goal_distances)) {
+        LOG_WARNING << "AStar can't reach the goals of " << agent.id << "!";
+        return {};
+      }
+      return path;
+    }
+
     // todo : fix this
     if (ts >= 10 * 1000) {
-      std::cerr << "AStar is stuck on " << agent.id << "!" << std::endl;
+      LOG_WARNING << "AStar is stuck on " << agent.id << "!";
       return {};
     }
 
     for (const auto& neighbour : neighbours) {
-      if (!do_visit(cur_state.path.back(), neighbour, ts + 1, cur_state.waiting_duration_opt)) {
+      if (!do_visit(cur_state.position, neighbour, ts + 1, cur_state.waiting_duration_opt)) {
         continue;
       }
-      auto new_path = cur_state.path;
-      new_path.push_back(neighbour);
+      nodes.push_back({neighbour, cur_state.node_idx});
 
       AStarState new_state = cur_state;
-      new_state.path = new_path;
-      if (new_state.waiting_duration_opt) {
-        if (new_state.waiting_duration_opt.value() + 1 >= graph.GetTimeToWaitNearCheckpoints()) {
-          new_state.waiting_duration_opt = std::nullopt;
-        } else {
-          ++new_state.waiting_duration_opt.value();
-        }
-      } else if (new_state.path.back() == agent.locations_to_visit[new_state.label]) {
-        ++new_state.label;
-        if (graph.GetTimeToWaitNearCheckpoints() > 1) {
-          new_state.waiting_duration_opt = 1;
-        }
-      }
-      ++new_state.ts;
+      new_state.node_idx = nodes.size() - 1;
+      new_state.Step(neighbour, agent, time_to_wait);
 
-      if (new_state.label == agent.locations_to_visit.size()
-          && (!new_state.waiting_duration_opt || graph.GetTimeToWaitNearCheckpoints() <= 1)) {
+      if (new_state.IsFinished(agent, time_to_wait)) {
         // AStar done
-        return new_state.path;
+        return RestorePath(nodes, new_state.node_idx);
       }
 
-      states.insert(std::move(new_state));
-      used.insert({neighbour, new_state.ts});
+      used.Insert(UsedStateKey(graph.GetCellIndex(neighbour), new_state.ts, std::nullopt));
+      push_state(std::move(new_state));
     }
   }
-  std::cerr << "AStar is stuck on " << agent.id << "!" << std::endl;
+  LOG_WARNING << "AStar is stuck on " << agent.id << "!";
   return {};
 }
+
+size_t GetAStarExpandedNodes() {
+  return expanded_nodes;
+}
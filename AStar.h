@@ -2,15 +2,22 @@
 
 #include "agents.h"
 #include "graph.h"
+#include "reservation_table.h"
 
+#include <set>
 #include <vector>
 #include <unordered_map>
 
+// With a horizon, constraints and reserved paths are respected only for the first
+// `horizon` timesteps. The path is then completed by walking the shortest routes
+// through the remaining locations, without any checks.
 std::vector<Point> AStar(
     const Agent& agent,
     const std::unordered_map<size_t, std::set<Point>>& vertex_conflicts,
     const std::unordered_map<size_t, std::set<Edge>>& edge_conflicts,
     const Graph& graph,
-    const std::optional<std::reference_wrapper<const std::vector<std::vector<Point>>>> paths_opt = std::nullopt,
-    const std::optional<std::reference_wrapper<const std::vector<size_t>>> topsort_order_opt = std::nullopt,
-    const std::optional<size_t> agent_topsort_idx = std::nullopt);
+    const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt = std::nullopt,
+    const std::optional<size_t> horizon_opt = std::nullopt);
+
+// Number of states AStar has expanded on the calling thread so far
+size_t GetAStarExpandedNodes();
@@ -1,6 +1,7 @@
 #include "CBS.h"
 
 #include "AStar.h"
+#include "logging.h"
 
 namespace {
 
@@ -8,7 +9,8 @@ std::vector<std::vector<Point>> GetPaths(
     const Agents& agents,
     const std::unordered_map<size_t,
     std::unordered_map<size_t, std::set<Point>>>& conflicts,
-    const Graph& graph) {
+    const Graph& graph,
+    const std::optional<size_t> horizon_opt) {
   std::vector<std::vector<Point>> result;
   result.reserve(agents.GetSize());
   for (const auto& agent : agents.GetAgents()) {
@@ -17,7 +19,10 @@ std::vector<std::vector<Point>> GetPaths(
         conflicts.count(agent.id)
             ? conflicts.at(agent.id)
             : std::unordered_map<size_t, std::set<Point>>{},
-        graph);
+        {},
+        graph,
+        std::nullopt,
+        horizon_opt);
     result.push_back(std::move(agent_path));
   }
   return result;
@@ -34,16 +39,17 @@ std::vector<std::vector<Point>> MakeCBSIteration(
     const Agents& agents,
     const Graph& graph,
     const TaskAssigner& task_assigner,
-    const size_t window_size) {
+    const size_t window_size,
+    const std::optional<size_t> horizon_opt) {
   auto states_cmp = [](const CBSState& s1, const CBSState& s2) { return s1.cost < s2.cost; };
   std::multiset<CBSState, decltype(states_cmp)> states(states_cmp);
 
   CBSState root;
-  root.paths = GetPaths(agents, root.conflicts, graph);
+  root.paths = GetPaths(agents, root.conflicts, graph, horizon_opt);
   root.cost = CalculateCost(root.paths);
   states.insert(root);
 
-  auto add_state_with_conflict = [&states, &agents, &graph] (
+  auto add_state_with_conflict = [&states, &agents, &graph, &horizon_opt] (
       CBSState state,
       const size_t agent_id,
       const size_t ts,
@@ -52,7 +58,10 @@ std::vector<std::vector<Point>> MakeCBSIteration(
     state.paths[agent_id] = AStar(
         agents.GetAgents()[agent_id],
         state.conflicts.at(agent_id),
-        graph);
+        {},
+        graph,
+        std::nullopt,
+        horizon_opt);
     if (state.paths[agent_id].empty()) {
       return;
     }
@@ -81,18 +90,22 @@ std::vector<std::vector<Point>> MakeCBSIteration(
     add_state_with_conflict(cur_state, conflict->agent_1, ts, position);
     add_state_with_conflict(cur_state, conflict->agent_2, ts, position);
   }
-  std::cerr << "Something went wrong CBS has no states!" << std::endl;
+  LOG_ERROR << "Something went wrong CBS has no states!";
   return {};
 }
 
 }
 
 std::vector<std::vector<Point>> ConflictBasedSearch(
-    Agents& agents, const Graph& graph, TaskAssigner& task_assigner, const size_t window_size) {
+    Agents& agents,
+    const Graph& graph,
+    TaskAssigner& task_assigner,
+    const size_t window_size,
+    const std::optional<size_t> low_level_horizon) {
   std::vector<std::vector<Point>> result(agents.GetSize());
   do {
     agents.UpdateTasksLists(task_assigner, window_size, graph);
-    const auto paths_prefixes = MakeCBSIteration(agents, graph, task_assigner, window_size);
+    const auto paths_prefixes = MakeCBSIteration(agents, graph, task_assigner, window_size, low_level_horizon);
     /*
     std::cerr << "ok, got paths" << std::endl;
     for (const auto& agent : paths_prefixes) {
@@ -103,7 +116,7 @@ std::vector<std::vector<Point>> ConflictBasedSearch(
     }
     */
     agents.DeleteCompletedTasks(paths_prefixes, window_size, graph.GetTimeToWaitNearCheckpoints());
-    std::cerr << "remaining tasks : " << task_assigner.RemainingTasks() << std::endl;
+    LOG_INFO << "remaining tasks : " << task_assigner.RemainingTasks();
     for (size_t i = 0; i < paths_prefixes.size(); ++i) {
       for (size_t j = 0; j < std::min(window_size, paths_prefixes[i].size()); ++j) {
         result[i].push_back(paths_prefixes[i][j]);
@@ -4,8 +4,14 @@
 #include "graph.h"
 #include "task_assigner.h"
 
+#include <optional>
 #include <vector>
 #include <unordered_map>
 
+// If low_level_horizon is set, AStar resolves constraints only for this many timesteps
 std::vector<std::vector<Point>> ConflictBasedSearch(
-    Agents& agents, const Graph& graph, TaskAssigner& task_assigner, const size_t window_size);
+    Agents& agents,
+    const Graph& graph,
+    TaskAssigner& task_assigner,
+    const size_t window_size,
+    const std::optional<size_t> low_level_horizon = std::nullopt);
@@ -1,34 +1,143 @@
 #include "PBS.h"
 
 #include "AStar.h"
+#include "conflicts_tracker.h"
+#include "logging.h"
+#include "reservation_table.h"
+#include "SIPP.h"
 #include "topsort.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 
+using VertexConstraints = std::unordered_map<size_t, std::set<Point>>;
+using EdgeConstraints = std::unordered_map<size_t, std::set<Edge>>;
+
+// Children share per-agent paths and constraints with their parent, only the entries
+// of the agents a child has changed are replaced
 struct PBSState {
   // agent -> time -> positions
-  std::unordered_map<size_t, std::unordered_map<size_t, std::set<Point>>> vertex_conflicts;
+  std::vector<std::shared_ptr<const VertexConstraints>> vertex_conflicts;
   // agent -> time -> edge
-  std::unordered_map<size_t, std::unordered_map<size_t, std::set<Edge>>> edge_conflicts;
-  std::vector<std::vector<Point>> paths;
-  std::vector<std::vector<size_t>> priority_graph;
-  int cost;
+  std::vector<std::shared_ptr<const EdgeConstraints>> edge_conflicts;
+  std::vector<SharedPath> paths;
+  // Agents in priority order, higher priority first
+  IncrementalTopSort priority_order;
+  // Conflicts between current paths within the window
+  ConflictsTracker conflicts_tracker;
+  int cost = 0;
 
   PBSState(const size_t size)
-  : paths(size)
-  , priority_graph(size) {
-    for (size_t i = 0; i < size; ++i) {
-      vertex_conflicts[i] = {};
-      edge_conflicts[i] = {};
-    }
+  : vertex_conflicts(size, std::make_shared<const VertexConstraints>())
+  , edge_conflicts(size, std::make_shared<const EdgeConstraints>())
+  , paths(size, std::make_shared<const std::vector<Point>>())
+  , priority_order(size)
+  , conflicts_tracker(size) {}
+
+  void SetPath(const size_t agent_id, std::vector<Point> path) {
+    cost += static_cast<int>(path.size()) - static_cast<int>(paths[agent_id]->size());
+    paths[agent_id] = std::make_shared<const std::vector<Point>>(std::move(path));
+  }
+
+  void AddVertexConstraint(const size_t agent_id, const size_t ts, const Point& position) {
+    auto constraints = std::make_shared<VertexConstraints>(*vertex_conflicts[agent_id]);
+    (*constraints)[ts].insert(position);
+    vertex_conflicts[agent_id] = std::move(constraints);
+  }
+
+  void AddEdgeConstraint(const size_t agent_id, const size_t ts, const Edge& edge) {
+    auto constraints = std::make_shared<EdgeConstraints>(*edge_conflicts[agent_id]);
+    (*constraints)[ts].insert(edge);
+    edge_conflicts[agent_id] = std::move(constraints);
   }
 };
 
 namespace {
 
-bool HasConflict(const std::vector<Point>& lhs, const std::vector<Point>& rhs) {
-  for (size_t ts = 0; ts < std::min(lhs.size(), rhs.size()); ++ts) {
+thread_local size_t generated_nodes = 0;
+
+// Helper threads of the parallel high level searches. They are started once per
+// PriorityBasedSearch call and reused by every window and batch instead of being spawned
+// for each of them. The calling thread works as one of the workers.
+class SearchWorkers {
+public:
+  SearchWorkers(const size_t threads_cnt) {
+    ASSERT(threads_cnt > 0);
+    helpers.reserve(threads_cnt - 1);
+    for (size_t i = 0; i + 1 < threads_cnt; ++i) {
+      helpers.emplace_back([this] () { HelperLoop(); });
+    }
+  }
+
+  ~SearchWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& helper : helpers) {
+      helper.join();
+    }
+  }
+
+  SearchWorkers(const SearchWorkers&) = delete;
+  SearchWorkers& operator=(const SearchWorkers&) = delete;
+
+  // Runs `job` on every helper and on the calling thread, returns when all of them are done
+  void Run(const std::function<void()>& job) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      current_job = &job;
+      running_helpers = helpers.size();
+      ++round;
+    }
+    start_cv.notify_all();
+    job();
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this] { return running_helpers == 0; });
+    current_job = nullptr;
+  }
+
+private:
+  void HelperLoop() {
+    size_t seen_round = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      start_cv.wait(lock, [&] { return stopping || round != seen_round; });
+      if (stopping) {
+        return;
+      }
+      seen_round = round;
+      const auto* job = current_job;
+      lock.unlock();
+      (*job)();
+      lock.lock();
+      if (--running_helpers == 0) {
+        done_cv.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> helpers;
+  std::mutex mtx;
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+  const std::function<void()>* current_job = nullptr;
+  size_t running_helpers = 0;
+  size_t round = 0;
+  bool stopping = false;
+};
+
+bool HasConflict(const std::vector<Point>& lhs, const std::vector<Point>& rhs, const size_t max_ts) {
+  for (size_t ts = 0; ts < std::min({lhs.size(), rhs.size(), max_ts}); ++ts) {
     // todo : add more constraints
     if (lhs[ts] == rhs[ts]) {
       return true;
@@ -37,20 +146,52 @@ bool HasConflict(const std::vector<Point>& lhs, const std::vector<Point>& rhs) {
   return false;
 }
 
-bool UpdatePaths(
+std::vector<Point> FindPath(
+    const PBSParams& params,
+    const Agent& agent,
+    const PBSState& pbs_state,
+    const Graph& graph,
+    const ReservationTable& reservation_table) {
+  if (params.low_level_planner == LowLevelPlanner::SIPP) {
+    return SIPP(
+        agent,
+        *pbs_state.vertex_conflicts[agent.id],
+        *pbs_state.edge_conflicts[agent.id],
+        graph,
+        std::cref(reservation_table));
+  }
+  return AStar(
+      agent,
+      *pbs_state.vertex_conflicts[agent.id],
+      *pbs_state.edge_conflicts[agent.id],
+      graph,
+      std::cref(reservation_table),
+      params.low_level_horizon);
+}
+
+// Replans the chosen agents (all of them if none are chosen) and every agent whose path
+// conflicts with a higher priority one
+void UpdatePaths(
     const Agents& agents,
     const Graph& graph,
+    const PBSParams& params,
+    const size_t window_size,
     PBSState& pbs_state,
-    const std::optional<size_t> update_path_for) {
-  const auto topsort_order_opt = TopSort(pbs_state.priority_graph);
-  if (!topsort_order_opt) {
-    std::cerr << "Topsort order is inconsistent!" << std::endl;
-    return false;
+    const std::optional<std::vector<size_t>>& update_paths_for) {
+  std::vector<bool> is_chosen(agents.GetSize(), !update_paths_for);
+  if (update_paths_for) {
+    for (const size_t agent_id : update_paths_for.value()) {
+      ASSERT(agent_id < agents.GetSize());
+      is_chosen[agent_id] = true;
+    }
   }
+  std::vector<size_t> updated_agents;
+  // Paths are not checked against each other beyond the low level horizon
+  const size_t conflicts_horizon = params.low_level_horizon.value_or(std::numeric_limits<size_t>::max());
+  // Paths of all agents preceding the current one in topsort order
+  ReservationTable reservation_table(graph);
 
-  std::vector<bool> path_updated(agents.GetSize(), false);
-
-  const auto& topsort_order = topsort_order_opt.value();
+  const auto& topsort_order = pbs_state.priority_order.GetOrder();
   for (size_t i = 0; i < topsort_order.size(); ++i) {
     const size_t agent_id = topsort_order[i];
     const Agent& agent = agents.At(agent_id);
@@ -58,122 +199,450 @@ bool UpdatePaths(
 
     // todo : update AStar according to paper
 
-    if (!update_path_for) {
-      // Update all paths
-      pbs_state.paths[agent_id] = AStar(
-        agent,
-        pbs_state.vertex_conflicts.at(agent_id),
-        pbs_state.edge_conflicts.at(agent_id),
-        graph,
-        std::cref(pbs_state.paths),
-        std::cref(topsort_order),
-        i);
-      path_updated[agent_id] = true;
-    } else {
-      // Update path only for the chosen agent and for all conflicting agents with lower priority
-      ASSERT(update_path_for.value() < agents.GetSize());
-      bool update_path = (update_path_for.value() == agent_id);
-      if (!update_path) {
-        for (size_t j = 0; j < i; ++j) {
-          const size_t higher_priority_agent_id = topsort_order[j];
-          if (HasConflict(pbs_state.paths[agent_id], pbs_state.paths[higher_priority_agent_id])) {
-            update_path = true;
-            break;
-          }
+    // Update path for the chosen agents and for all conflicting agents with lower priority
+    bool update_path = is_chosen[agent_id];
+    if (!update_path) {
+      for (size_t j = 0; j < i; ++j) {
+        const size_t higher_priority_agent_id = topsort_order[j];
+        if (HasConflict(
+            *pbs_state.paths[agent_id], *pbs_state.paths[higher_priority_agent_id], conflicts_horizon)) {
+          update_path = true;
+          break;
         }
       }
-      if (update_path) {
-        pbs_state.paths[agent_id] = AStar(
-          agent,
-          pbs_state.vertex_conflicts.at(agent.id),
-          pbs_state.edge_conflicts.at(agent.id),
-          graph,
-          std::cref(pbs_state.paths),
-          std::cref(topsort_order),
-          i);
-        path_updated[agent_id] = true;
-      }
     }
+    if (update_path) {
+      pbs_state.SetPath(agent_id, FindPath(params, agent, pbs_state, graph, reservation_table));
+      updated_agents.push_back(agent_id);
+    }
+    reservation_table.Reserve(*pbs_state.paths[agent_id]);
+  }
+  pbs_state.conflicts_tracker.Update(pbs_state.paths, updated_agents, window_size);
+}
+
+// Child of `state` in which the conflict is resolved by giving agent_id_high_priority
+// a higher priority than agent_id_low_priority
+std::optional<PBSState> MakeChildState(
+    const Agents& agents,
+    const Graph& graph,
+    const PBSParams& params,
+    const size_t window_size,
+    PBSState state,
+    const size_t agent_id_low_priority,
+    const size_t agent_id_high_priority,
+    const ConflictBase& conflict) {
+  const size_t ts = conflict.ts;
+  const auto& low_priority_path = *state.paths[agent_id_low_priority];
+
+  if (conflict.conflict_type == ConflictType::VertexConflict) {
+    const Point position = dynamic_cast<const VertexConflict&>(conflict).conflicting_vertex;
+    ASSERT(position == low_priority_path[ts]);
+    state.AddVertexConstraint(agent_id_low_priority, ts, position);
+  } else if (conflict.conflict_type == ConflictType::EdgeConflict) {
+    Edge edge = dynamic_cast<const EdgeConflict&>(conflict).conflicting_edge;
+    if (low_priority_path[ts - 1] != edge.first && low_priority_path[ts] != edge.second) {
+      std::swap(edge.second, edge.first);
+    }
+    ASSERT(edge.first == low_priority_path[ts - 1]);
+    ASSERT(edge.second == low_priority_path[ts]);
+    state.AddEdgeConstraint(agent_id_low_priority, ts, edge);
+  } else {
+    std::cerr << "Conflict has no type!" << std::endl;
+    exit(0);
   }
-  return true;
+
+  if (!state.priority_order.AddEdge(agent_id_high_priority, agent_id_low_priority)) {
+    LOG_DEBUG << "Topsort order is inconsistent!";
+    return std::nullopt;
+  }
+
+  UpdatePaths(agents, graph, params, window_size, state, std::vector<size_t>{agent_id_low_priority});
+  if (state.paths[agent_id_low_priority]->empty()) {
+    return std::nullopt;
+  }
+  ++generated_nodes;
+  return state;
 }
 
-std::vector<std::vector<Point>> MakePBSIteration(
+std::vector<std::vector<Point>> GetPaths(const PBSState& state) {
+  std::vector<std::vector<Point>> paths;
+  paths.reserve(state.paths.size());
+  for (const auto& path : state.paths) {
+    paths.push_back(*path);
+  }
+  return paths;
+}
+
+// Best-first search over all open nodes ordered by cost
+std::optional<PBSState> SearchBestFirst(
     const Agents& agents,
     const Graph& graph,
-    const TaskAssigner& task_assigner,
-    const size_t window_size) {
+    const size_t window_size,
+    const PBSParams& params,
+    PBSState root) {
   auto states_cmp = [](const PBSState& s1, const PBSState& s2) { return s1.cost < s2.cost; };
   std::multiset<PBSState, decltype(states_cmp)> states(states_cmp);
+  states.insert(std::move(root));
 
-  PBSState root(agents.GetSize());
-  ASSERT(UpdatePaths(agents, graph, root, std::nullopt));
-  root.cost = CalculateCost(root.paths);
-  states.insert(root);
-
-  auto add_state_with_conflict = [&states, &agents, &graph] (
-      PBSState state,
-      const size_t agent_id_low_priority,
-      const size_t agent_id_high_priority,
-      const ConflictBase& conflict) {
-    const size_t ts = conflict.ts;
-
-    if (conflict.conflict_type == ConflictType::VertexConflict) {
-      const Point position = dynamic_cast<const VertexConflict&>(conflict).conflicting_vertex;
-      ASSERT(position == state.paths[agent_id_low_priority][ts]);
-      state.vertex_conflicts[agent_id_low_priority][ts].insert(position);
-    } else if (conflict.conflict_type == ConflictType::EdgeConflict) {
-      Edge edge = dynamic_cast<const EdgeConflict&>(conflict).conflicting_edge;
-      if (state.paths[agent_id_low_priority][ts - 1] != edge.first
-          && state.paths[agent_id_low_priority][ts] != edge.second) {
-        std::swap(edge.second, edge.first);
-      }
-      ASSERT(edge.first == state.paths[agent_id_low_priority][ts - 1]);
-      ASSERT(edge.second == state.paths[agent_id_low_priority][ts]);
-      state.edge_conflicts[agent_id_low_priority][ts].insert(std::move(edge));
-    } else {
-      std::cerr << "Conflict has no type!" << std::endl;
-      exit(0);
+  Random generator(params.seed);
+  while (!states.empty()) {
+    PBSState cur_state = std::move(states.extract(states.begin()).value());
+    auto conflict = cur_state.conflicts_tracker.Select(params.conflict_selection, generator);
+    if (!conflict) {
+      // CBS done
+      return cur_state;
+    }
+    // The first child copies only pointers, the second one takes over the parent
+    auto first_child = MakeChildState(
+        agents, graph, params, window_size, cur_state, conflict->agent_1, conflict->agent_2, *conflict);
+    if (first_child) {
+      states.insert(std::move(first_child.value()));
     }
+    auto second_child = MakeChildState(
+        agents, graph, params, window_size, std::move(cur_state), conflict->agent_2, conflict->agent_1, *conflict);
+    if (second_child) {
+      states.insert(std::move(second_child.value()));
+    }
+  }
+  LOG_ERROR << "Something went wrong CBS has no states!";
+  return std::nullopt;
+}
 
-    state.priority_graph[agent_id_high_priority].push_back(agent_id_low_priority);
+// Depth-first search as in the original PBS: the cheaper child is expanded first and its
+// sibling stays on the stack for backtracking, so only O(depth) nodes are kept
+std::optional<PBSState> SearchDepthFirst(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    PBSState root) {
+  std::vector<PBSState> states;
+  states.push_back(std::move(root));
 
-    if (!UpdatePaths(agents, graph, state, agent_id_low_priority)
-        || state.paths[agent_id_low_priority].empty()) {
-      return;
+  Random generator(params.seed);
+  while (!states.empty()) {
+    PBSState cur_state = std::move(states.back());
+    states.pop_back();
+    auto conflict = cur_state.conflicts_tracker.Select(params.conflict_selection, generator);
+    if (!conflict) {
+      // PBS done
+      return cur_state;
+    }
+    auto first_child = MakeChildState(
+        agents, graph, params, window_size, cur_state, conflict->agent_1, conflict->agent_2, *conflict);
+    auto second_child = MakeChildState(
+        agents, graph, params, window_size, std::move(cur_state), conflict->agent_2, conflict->agent_1, *conflict);
+    if (first_child && second_child && second_child->cost < first_child->cost) {
+      std::swap(first_child, second_child);
+    }
+    if (second_child) {
+      states.push_back(std::move(second_child.value()));
+    }
+    if (first_child) {
+      states.push_back(std::move(first_child.value()));
+    }
+  }
+  LOG_ERROR << "Something went wrong PBS has no states!";
+  return std::nullopt;
+}
+
+// Best-first search in which several workers share the open list. A worker that pops a node
+// expands the first child itself and leaves the second one to any idle worker, so both
+// children are planned at the same time. The result depends on thread timings.
+std::optional<PBSState> SearchParallel(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    SearchWorkers& workers,
+    PBSState root) {
+  struct Expansion {
+    std::shared_ptr<const PBSState> parent;
+    std::shared_ptr<ConflictBase> conflict;
+  };
+
+  auto states_cmp = [](const PBSState& s1, const PBSState& s2) { return s1.cost < s2.cost; };
+  std::multiset<PBSState, decltype(states_cmp)> states(states_cmp);
+  states.insert(std::move(root));
+  std::vector<Expansion> expansions;
+  size_t busy_workers = 0;
+  std::optional<PBSState> result;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  Random generator(params.seed);
+
+  const auto worker = [&] () {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      cv.wait(lock, [&] {
+        return result || !expansions.empty() || !states.empty() || busy_workers == 0;
+      });
+      if (result || (expansions.empty() && states.empty())) {
+        // Either solved or nobody can produce new nodes anymore
+        cv.notify_all();
+        return;
+      }
+
+      PBSState state(0);
+      std::shared_ptr<ConflictBase> conflict;
+      size_t agent_id_low_priority;
+      size_t agent_id_high_priority;
+      if (!expansions.empty()) {
+        Expansion expansion = std::move(expansions.back());
+        expansions.pop_back();
+        state = *expansion.parent;
+        conflict = std::move(expansion.conflict);
+        agent_id_low_priority = conflict->agent_2;
+        agent_id_high_priority = conflict->agent_1;
+      } else {
+        state = std::move(states.extract(states.begin()).value());
+        conflict = state.conflicts_tracker.Select(params.conflict_selection, generator);
+        if (!conflict) {
+          // PBS done
+          result = std::move(state);
+          cv.notify_all();
+          return;
+        }
+        expansions.push_back({std::make_shared<const PBSState>(state), conflict});
+        cv.notify_one();
+        agent_id_low_priority = conflict->agent_1;
+        agent_id_high_priority = conflict->agent_2;
+      }
+      ++busy_workers;
+      lock.unlock();
+
+      auto child = MakeChildState(
+          agents, graph, params, window_size, std::move(state),
+          agent_id_low_priority, agent_id_high_priority, *conflict);
+
+      lock.lock();
+      --busy_workers;
+      if (child) {
+        states.insert(std::move(child.value()));
+      }
+      cv.notify_all();
     }
-    state.cost = CalculateCost(state.paths);
-    states.insert(std::move(state));
   };
 
+  workers.Run(worker);
+
+  if (!result) {
+    LOG_ERROR << "Something went wrong PBS has no states!";
+  }
+  return result;
+}
+
+// Reproducible parallel best-first search. Up to `params.threads` cheapest nodes are popped
+// as a batch, all of their children are planned in parallel and then inserted in batch
+// order, so the result does not depend on thread timings.
+std::optional<PBSState> SearchParallelDeterministic(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    SearchWorkers& workers,
+    PBSState root) {
+  auto states_cmp = [](const PBSState& s1, const PBSState& s2) { return s1.cost < s2.cost; };
+  std::multiset<PBSState, decltype(states_cmp)> states(states_cmp);
+  states.insert(std::move(root));
+
+  Random generator(params.seed);
+  std::vector<std::pair<PBSState, std::shared_ptr<ConflictBase>>> batch;
+  std::vector<std::optional<PBSState>> children;
   while (!states.empty()) {
-    const PBSState cur_state = *(states.begin());
-    states.erase(states.begin());
-    auto conflict = FindFirstConflict(cur_state.paths, window_size);
-    if (!conflict) {
-      // CBS done
-      return cur_state.paths;
+    batch.clear();
+    while (!states.empty() && batch.size() < params.threads) {
+      PBSState cur_state = std::move(states.extract(states.begin()).value());
+      auto conflict = cur_state.conflicts_tracker.Select(params.conflict_selection, generator);
+      if (!conflict) {
+        // PBS done
+        return cur_state;
+      }
+      batch.emplace_back(std::move(cur_state), std::move(conflict));
+    }
+
+    // Child 2 * i gives priority to agent_2 of the i-th conflict, child 2 * i + 1 to agent_1
+    children.assign(2 * batch.size(), std::nullopt);
+    std::atomic<size_t> next_child = 0;
+    const auto worker = [&] () {
+      for (size_t idx = next_child++; idx < children.size(); idx = next_child++) {
+        const auto& [state, conflict] = batch[idx / 2];
+        const size_t agent_id_low_priority = idx % 2 == 0 ? conflict->agent_1 : conflict->agent_2;
+        const size_t agent_id_high_priority = idx % 2 == 0 ? conflict->agent_2 : conflict->agent_1;
+        children[idx] = MakeChildState(
+            agents, graph, params, window_size, state,
+            agent_id_low_priority, agent_id_high_priority, *conflict);
+      }
+    };
+    workers.Run(worker);
+
+    for (auto& child : children) {
+      if (child) {
+        states.insert(std::move(child.value()));
+      }
+    }
+  }
+  LOG_ERROR << "Something went wrong PBS has no states!";
+  return std::nullopt;
+}
+
+// Root of the PBS tree. With a previous solution the root keeps its priority order and
+// the not yet executed parts of its paths, only the agents that got new tasks and the
+// agents conflicting with them are replanned.
+PBSState MakeRootState(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    const std::optional<PBSState>& previous_solution,
+    const std::vector<size_t>& changed_agents) {
+  PBSState root(agents.GetSize());
+  if (!previous_solution && params.independent_root) {
+    const ReservationTable empty_reservation_table(graph);
+    std::vector<size_t> planned_agents;
+    for (const auto& agent : agents.GetAgents()) {
+      root.SetPath(agent.id, FindPath(params, agent, root, graph, empty_reservation_table));
+      planned_agents.push_back(agent.id);
+    }
+    root.conflicts_tracker.Update(root.paths, planned_agents, window_size);
+    return root;
+  }
+  if (!previous_solution) {
+    UpdatePaths(agents, graph, params, window_size, root, std::nullopt);
+    return root;
+  }
+
+  std::vector<bool> is_changed(agents.GetSize(), false);
+  for (const size_t agent_id : changed_agents) {
+    is_changed[agent_id] = true;
+  }
+  std::vector<bool> is_reused(agents.GetSize(), false);
+  std::vector<size_t> reused_agents;
+  std::vector<size_t> replanned_agents;
+  for (const auto& agent : agents.GetAgents()) {
+    const auto& previous_path = *previous_solution->paths[agent.id];
+    // Path has to continue past the executed prefix, which ends at the agent's new start
+    if (is_changed[agent.id] || agent.locations_to_visit.empty() || previous_path.size() <= window_size) {
+      replanned_agents.push_back(agent.id);
+      continue;
+    }
+    ASSERT(previous_path[window_size - 1] == agent.start);
+    root.SetPath(agent.id, std::vector<Point>(previous_path.begin() + window_size - 1, previous_path.end()));
+    reused_agents.push_back(agent.id);
+    is_reused[agent.id] = true;
+  }
+
+  // Reused agents go first, so that replanned agents plan around them instead of
+  // invalidating their paths. Both groups keep their previous relative order.
+  std::vector<size_t> order = previous_solution->priority_order.GetOrder();
+  std::stable_partition(order.begin(), order.end(), [&is_reused] (const size_t agent_id) {
+    return is_reused[agent_id];
+  });
+  root.priority_order = IncrementalTopSort(order);
+
+  // Suffixes were conflict-free only inside the previous window
+  root.conflicts_tracker.Update(root.paths, reused_agents, window_size);
+  UpdatePaths(agents, graph, params, window_size, root, replanned_agents);
+  return root;
+}
+
+std::optional<PBSState> Search(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    std::optional<SearchWorkers>& workers,
+    PBSState root) {
+  if (params.search_mode == PBSSearchMode::DepthFirst) {
+    return SearchDepthFirst(agents, graph, window_size, params, std::move(root));
+  }
+  if (workers) {
+    if (params.deterministic) {
+      return SearchParallelDeterministic(agents, graph, window_size, params, *workers, std::move(root));
     }
-    add_state_with_conflict(cur_state, conflict->agent_1, conflict->agent_2, *conflict);
-    add_state_with_conflict(cur_state, conflict->agent_2, conflict->agent_1, *conflict);
+    return SearchParallel(agents, graph, window_size, params, *workers, std::move(root));
+  }
+  return SearchBestFirst(agents, graph, window_size, params, std::move(root));
+}
+
+std::optional<PBSState> MakePBSIteration(
+    const Agents& agents,
+    const Graph& graph,
+    const size_t window_size,
+    const PBSParams& params,
+    const std::optional<PBSState>& previous_solution,
+    const std::vector<size_t>& changed_agents,
+    std::optional<SearchWorkers>& workers) {
+  PBSState root = MakeRootState(agents, graph, window_size, params, previous_solution, changed_agents);
+  auto solution = Search(agents, graph, window_size, params, workers, std::move(root));
+  if (!solution && !previous_solution && params.independent_root) {
+    // Conflicts of independent paths may have no resolution at all, e.g. when an agent waits
+    // at its goal on the only way of another one. A prioritized root avoids most of them.
+    LOG_WARNING << "PBS failed from an independent root, retrying from a prioritized one";
+    PBSParams prioritized_root_params = params;
+    prioritized_root_params.independent_root = false;
+    root = MakeRootState(
+        agents, graph, window_size, prioritized_root_params, previous_solution, changed_agents);
+    solution = Search(agents, graph, window_size, params, workers, std::move(root));
+  }
+  return solution;
+}
+
+}
+
+LowLevelPlanner ParseLowLevelPlanner(const std::string& name) {
+  if (name == "astar") {
+    return LowLevelPlanner::AStar;
+  } else if (name == "sipp") {
+    return LowLevelPlanner::SIPP;
   }
-  std::cerr << "Something went wrong CBS has no states!" << std::endl;
-  return {};
+  std::cout << "Unknown low level planner : " << name << std::endl;
+  exit(1);
 }
 
+PBSSearchMode ParsePBSSearchMode(const std::string& name) {
+  if (name == "best_first") {
+    return PBSSearchMode::BestFirst;
+  } else if (name == "depth_first") {
+    return PBSSearchMode::DepthFirst;
+  }
+  std::cout << "Unknown PBS search mode : " << name << std::endl;
+  exit(1);
 }
 
 // todo : this is the same as CBS, merge them
 std::vector<std::vector<Point>> PriorityBasedSearch(
-    Agents& agents, const Graph& graph, TaskAssigner& task_assigner, const size_t window_size) {
+    Agents& agents,
+    const Graph& graph,
+    TaskAssigner& task_assigner,
+    const size_t window_size,
+    const PBSParams& params) {
+  ASSERT(!params.low_level_horizon || params.low_level_horizon.value() >= window_size);
+  // SIPP has no horizon, conflicts must not be checked only up to it
+  ASSERT(!params.low_level_horizon || params.low_level_planner == LowLevelPlanner::AStar);
   std::vector<std::vector<Point>> result(agents.GetSize());
   bool has_tasks = false;
+  std::optional<PBSState> previous_solution;
+  std::optional<SearchWorkers> workers;
+  if (params.search_mode == PBSSearchMode::BestFirst && params.threads > 1) {
+    workers.emplace(params.threads);
+  }
   do {
-    agents.UpdateTasksLists(task_assigner, window_size, graph);
-    const auto paths_prefixes = MakePBSIteration(agents, graph, task_assigner, window_size);
+    const auto changed_agents = agents.UpdateTasksLists(task_assigner, window_size, graph);
+    auto solution = MakePBSIteration(
+        agents,
+        graph,
+        window_size,
+        params,
+        params.warm_start ? previous_solution : std::nullopt,
+        changed_agents,
+        workers);
+    const auto paths_prefixes = solution ? GetPaths(solution.value()) : std::vector<std::vector<Point>>{};
+    previous_solution = std::move(solution);
     has_tasks = agents.DeleteCompletedTasks(
         paths_prefixes, window_size, graph.GetTimeToWaitNearCheckpoints());
-    std::cerr << "remaining tasks : " << task_assigner.RemainingTasks() << std::endl;
+    LOG_INFO << "remaining tasks : " << task_assigner.RemainingTasks();
     for (size_t i = 0; i < paths_prefixes.size(); ++i) {
       for (size_t j = 0; j < std::min(window_size, paths_prefixes[i].size()); ++j) {
         if (j == 0 && !result[i].empty()) {
@@ -184,4 +653,8 @@ std::vector<std::vector<Point>> PriorityBasedSearch(
     }
   } while (task_assigner.HasAssignments() || has_tasks);
   return result;
-}
\ No newline at end of file
+}
+
+size_t GetPBSGeneratedNodes() {
+  return generated_nodes;
+}
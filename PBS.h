@@ -1,10 +1,58 @@
 #pragma once
 
 #include "agents.h"
+#include "conflicts_tracker.h"
 #include "graph.h"
 #include "task_assigner.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <vector>
 
+enum class LowLevelPlanner {
+  AStar,
+  SIPP
+};
+
+LowLevelPlanner ParseLowLevelPlanner(const std::string& name);
+
+enum class PBSSearchMode {
+  // Expands the cheapest open node
+  BestFirst,
+  // Expands the cheaper child first and backtracks, keeps O(depth) nodes
+  DepthFirst
+};
+
+PBSSearchMode ParsePBSSearchMode(const std::string& name);
+
+struct PBSParams {
+  LowLevelPlanner low_level_planner = LowLevelPlanner::AStar;
+  ConflictSelection conflict_selection = ConflictSelection::Earliest;
+  PBSSearchMode search_mode = PBSSearchMode::BestFirst;
+  // Workers of the best-first high level search, 1 keeps it sequential
+  size_t threads = 1;
+  // Expand nodes in fixed batches so that parallel runs are reproducible
+  bool deterministic = false;
+  // Seed every window with the priority order and path suffixes of the previous one
+  bool warm_start = false;
+  // Plan every agent of a new root on its own, as the original PBS does, and leave all of
+  // their conflicts to the high level search. Otherwise the root is a prioritized planning
+  // solution, which is usually conflict-free already.
+  bool independent_root = false;
+  // If set, AStar resolves constraints only for this many timesteps and estimates the rest
+  // of the path. It should not be shorter than the window.
+  std::optional<size_t> low_level_horizon;
+  // Seed of the random conflict selection
+  uint64_t seed = 42;
+};
+
 std::vector<std::vector<Point>> PriorityBasedSearch(
-    Agents& agents, const Graph& graph, TaskAssigner& task_assigner, const size_t window_size);
\ No newline at end of file
+    Agents& agents,
+    const Graph& graph,
+    TaskAssigner& task_assigner,
+    const size_t window_size,
+    const PBSParams& params = PBSParams());
+
+// Number of high level nodes PBS has generated on the calling thread so far
+size_t GetPBSGeneratedNodes();
\ No newline at end of file
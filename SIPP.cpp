@@ -0,0 +1,277 @@
+#include "SIPP.h"
+
+#include "logging.h"
+#include "search_containers.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr size_t kInfinity = std::numeric_limits<size_t>::max();
+constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+// Same give-up limit as in AStar
+constexpr size_t kMaxTimestep = 10 * 1000;
+
+thread_local size_t expanded_nodes = 0;
+
+// Inclusive range of timesteps during which a cell is free
+struct SafeInterval {
+  size_t start;
+  size_t end;
+};
+
+struct SIPPNode {
+  Point position;
+  size_t interval_idx;
+  size_t label;
+  // Timestep the agent entered the cell
+  size_t arrival;
+  // Earliest timestep the agent may leave the cell, differs from arrival while dwelling at a checkpoint
+  size_t time;
+  size_t parent;
+};
+
+// Safe intervals of every cell, computed lazily the first time a cell is reached
+class SafeIntervals {
+public:
+  SafeIntervals(
+      const Graph& graph_,
+      const std::unordered_map<size_t, std::set<Point>>& vertex_conflicts,
+      const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt_)
+    : graph(graph_)
+    , reservation_table_opt(reservation_table_opt_) {
+    for (const auto& [ts, positions] : vertex_conflicts) {
+      for (const auto& position : positions) {
+        constrained_timesteps[graph.GetCellIndex(position)].push_back(ts);
+      }
+    }
+    ++search_stamp;
+    if (stamps.size() < graph.GetCellsNumber()) {
+      stamps.resize(graph.GetCellsNumber(), 0);
+      intervals.resize(graph.GetCellsNumber());
+    }
+  }
+
+  const std::vector<SafeInterval>& Get(const Point& pos) {
+    const size_t cell = graph.GetCellIndex(pos);
+    if (stamps[cell] == search_stamp) {
+      return intervals[cell];
+    }
+    stamps[cell] = search_stamp;
+    auto& cell_intervals = intervals[cell];
+    cell_intervals.clear();
+
+    // Merge constraint timesteps with timesteps reserved by higher priority agents
+    blocked.clear();
+    const auto constrained_it = constrained_timesteps.find(cell);
+    if (constrained_it != constrained_timesteps.end()) {
+      blocked.insert(blocked.end(), constrained_it->second.begin(), constrained_it->second.end());
+    }
+    if (reservation_table_opt) {
+      const auto [first, last] = reservation_table_opt->get().GetReservedTimesteps(pos);
+      blocked.insert(blocked.end(), first, last);
+    }
+    std::sort(blocked.begin(), blocked.end());
+
+    // Positions at timestep 0 are given, so it is never blocked
+    size_t interval_start = 0;
+    for (const size_t ts : blocked) {
+      if (ts == 0 || ts < interval_start) {
+        continue;
+      }
+      if (ts > interval_start) {
+        cell_intervals.push_back({interval_start, ts - 1});
+      }
+      interval_start = ts + 1;
+    }
+    cell_intervals.push_back({interval_start, kInfinity});
+    return cell_intervals;
+  }
+
+private:
+  const Graph& graph;
+  const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt;
+  std::unordered_map<size_t, std::vector<size_t>> constrained_timesteps;
+  std::vector<size_t> blocked;
+
+  static thread_local uint32_t search_stamp;
+  static thread_local std::vector<uint32_t> stamps;
+  static thread_local std::vector<std::vector<SafeInterval>> intervals;
+};
+
+thread_local uint32_t SafeIntervals::search_stamp = 0;
+thread_local std::vector<uint32_t> SafeIntervals::stamps;
+thread_local std::vector<std::vector<SafeInterval>> SafeIntervals::intervals;
+
+uint64_t NodeKey(const size_t cell, const size_t interval_idx, const size_t label) {
+  return static_cast<uint64_t>(cell)
+      | (static_cast<uint64_t>(interval_idx) << 28)
+      | (static_cast<uint64_t>(label) << 46);
+}
+
+std::vector<Point> RestorePath(const std::vector<SIPPNode>& nodes, const size_t node_idx) {
+  std::vector<size_t> chain;
+  for (size_t idx = node_idx; idx != kNoParent; idx = nodes[idx].parent) {
+    chain.push_back(idx);
+  }
+  std::reverse(chain.begin(), chain.end());
+
+  std::vector<Point> path;
+  for (const size_t idx : chain) {
+    const SIPPNode& node = nodes[idx];
+    // Wait in the previous cell until it is time to move
+    while (!path.empty() && path.size() < node.arrival) {
+      path.push_back(path.back());
+    }
+    while (path.size() <= node.time) {
+      path.push_back(node.position);
+    }
+  }
+  return path;
+}
+
+}
+
+std::vector<Point> SIPP(
+    const Agent& agent,
+    const std::unordered_map<size_t, std::set<Point>>& vertex_conflicts,
+    const std::unordered_map<size_t, std::set<Edge>>& edge_conflicts,
+    const Graph& graph,
+    const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt) {
+  if (agent.locations_to_visit.empty()) {
+    return {};
+  }
+  const size_t time_to_wait = graph.GetTimeToWaitNearCheckpoints();
+  const size_t goals_number = agent.locations_to_visit.size();
+
+  std::vector<std::shared_ptr<const DistanceTable>> goal_distances;
+  goal_distances.reserve(goals_number);
+  for (const auto& location : agent.locations_to_visit) {
+    goal_distances.push_back(graph.GetDistanceTable(location));
+  }
+  const auto lower_bound_to_goal = [&] (const Point& position, const size_t label) -> size_t {
+    const uint32_t distance = (*goal_distances[label])[graph.GetCellIndex(position)];
+    if (distance == DistancesCache::kUnreachable) {
+      const Point& goal = agent.locations_to_visit[label];
+      return std::abs(position.x - goal.x) + std::abs(position.y - goal.y);
+    }
+    return distance;
+  };
+
+  const auto is_edge_blocked = [&] (const Point& from, const Point& to, const size_t ts) {
+    const auto edge_conflicts_it = edge_conflicts.find(ts);
+    if (edge_conflicts_it != edge_conflicts.end() && edge_conflicts_it->second.count({from, to})) {
+      return true;
+    }
+    return reservation_table_opt && reservation_table_opt->get().IsEdgeReserved(from, to, ts);
+  };
+
+  SafeIntervals safe_intervals(graph, vertex_conflicts, reservation_table_opt);
+  thread_local BucketOpenList<size_t> states;
+  thread_local std::unordered_map<uint64_t, size_t> best_time;
+  thread_local std::vector<SIPPNode> nodes;
+  states.Clear();
+  best_time.clear();
+  nodes.clear();
+
+  std::optional<size_t> goal_node_idx;
+  // Enters the cell at `arrival`, reaching a checkpoint also makes the agent dwell there
+  const auto visit = [&] (
+      const Point& position,
+      const size_t interval_idx,
+      const SafeInterval& interval,
+      size_t label,
+      const size_t arrival,
+      const size_t parent) {
+    size_t time = arrival;
+    if (position == agent.locations_to_visit[label]) {
+      time += time_to_wait > 1 ? time_to_wait - 1 : 0;
+      if (time > interval.end) {
+        // Can't stay at the checkpoint long enough
+        return;
+      }
+      ++label;
+    }
+    if (label == goals_number) {
+      nodes.push_back({position, interval_idx, label, arrival, time, parent});
+      goal_node_idx = nodes.size() - 1;
+      return;
+    }
+    const uint64_t key = NodeKey(graph.GetCellIndex(position), interval_idx, label);
+    const auto best_time_it = best_time.find(key);
+    if (best_time_it != best_time.end() && best_time_it->second <= time) {
+      return;
+    }
+    best_time[key] = time;
+    nodes.push_back({position, interval_idx, label, arrival, time, parent});
+    states.Push(nodes.size() - 1, label, time + lower_bound_to_goal(position, label));
+  };
+
+  // Agent may still have to dwell at the checkpoint it has reached in the previous window
+  const size_t start_time = agent.waiting_duration_opt
+      ? time_to_wait - std::min(time_to_wait, agent.waiting_duration_opt.value())
+      : 0;
+  const auto& start_intervals = safe_intervals.Get(agent.start);
+  if (start_intervals.front().start != 0 || start_intervals.front().end < start_time) {
+    LOG_WARNING << "SIPP is stuck on " << agent.id << "!";
+    return {};
+  }
+  nodes.push_back({agent.start, 0, 0, 0, start_time, kNoParent});
+  best_time[NodeKey(graph.GetCellIndex(agent.start), 0, 0)] = start_time;
+  states.Push(0, 0, start_time + lower_bound_to_goal(agent.start, 0));
+
+  while (!states.Empty() && !goal_node_idx) {
+    const size_t node_idx = states.Pop();
+    const SIPPNode node = nodes[node_idx];
+    const uint64_t key = NodeKey(graph.GetCellIndex(node.position), node.interval_idx, node.label);
+    if (best_time.at(key) < node.time) {
+      // A better copy of this node was expanded already
+      continue;
+    }
+    ++expanded_nodes;
+    if (node.time >= kMaxTimestep) {
+      LOG_WARNING << "SIPP is stuck on " << agent.id << "!";
+      return {};
+    }
+    const SafeInterval interval = safe_intervals.Get(node.position)[node.interval_idx];
+
+    if (node.position == agent.locations_to_visit[node.label] && node.time + 1 <= interval.end) {
+      // Staying in place counts as reaching the checkpoint
+      visit(node.position, node.interval_idx, interval, node.label, node.time + 1, node_idx);
+    }
+
+    const size_t latest_arrival = interval.end == kInfinity ? kInfinity : interval.end + 1;
+    for (const auto& neighbour : graph.GetNeighbours(node.position, false)) {
+      const auto& neighbour_intervals = safe_intervals.Get(neighbour);
+      for (size_t i = 0; i < neighbour_intervals.size(); ++i) {
+        const SafeInterval neighbour_interval = neighbour_intervals[i];
+        if (neighbour_interval.start > latest_arrival) {
+          break;
+        }
+        if (neighbour_interval.end < node.time + 1) {
+          continue;
+        }
+        size_t arrival = std::max(node.time + 1, neighbour_interval.start);
+        const size_t last_arrival = std::min(latest_arrival, neighbour_interval.end);
+        while (arrival <= last_arrival && is_edge_blocked(node.position, neighbour, arrival)) {
+          ++arrival;
+        }
+        if (arrival > last_arrival) {
+          continue;
+        }
+        visit(neighbour, i, neighbour_interval, node.label, arrival, node_idx);
+      }
+    }
+  }
+
+  if (!goal_node_idx) {
+    LOG_WARNING << "SIPP is stuck on " << agent.id << "!";
+    return {};
+  }
+  return RestorePath(nodes, goal_node_idx.value());
+}
+
+size_t GetSIPPExpandedNodes() {
+  return expanded_nodes;
+}
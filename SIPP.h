@@ -0,0 +1,22 @@
+#pragma once
+
+#include "agents.h"
+#include "graph.h"
+#include "reservation_table.h"
+
+#include <set>
+#include <vector>
+#include <unordered_map>
+
+// Safe Interval Path Planning: same contract as AStar, but waiting is implicit.
+// Every cell is split into maximal intervals of timesteps that are free of constraints and
+// higher priority agents, search nodes are (cell, safe interval, label) triples.
+std::vector<Point> SIPP(
+    const Agent& agent,
+    const std::unordered_map<size_t, std::set<Point>>& vertex_conflicts,
+    const std::unordered_map<size_t, std::set<Edge>>& edge_conflicts,
+    const Graph& graph,
+    const std::optional<std::reference_wrapper<const ReservationTable>> reservation_table_opt = std::nullopt);
+
+// Number of nodes SIPP has expanded on the calling thread so far
+size_t GetSIPPExpandedNodes();
@@ -1,5 +1,8 @@
 #include "agents.h"
 
+#include "logging.h"
+#include "random.h"
+
 
 void Agent::PrintDebugInfo(std::ostream& ostream) const {
   ostream << "All assignments for agent " << id << ": ";
@@ -14,14 +17,13 @@ void Agent::PrintDebugInfo(std::ostream& ostream) const {
   ostream << std::endl;
 }
 
-size_t Agent::CalculateLowerBound(const size_t waiting_duration) const {
+size_t Agent::CalculateLowerBound(const Graph& graph) const {
+  const size_t waiting_duration = graph.GetTimeToWaitNearCheckpoints();
   size_t result = 0;
   for (size_t i = 0; i < locations_to_visit.size(); ++i) {
     const Point& prev_location = (i == 0) ? start : locations_to_visit[i - 1];
     const Point& cur_location = locations_to_visit[i];
-    result += std::abs(prev_location.x - cur_location.x)
-        + std::abs(prev_location.y - cur_location.y)
-        + (waiting_duration - 1);
+    result += graph.GetDistance(prev_location, cur_location) + (waiting_duration - 1);
   }
   return result;
 }
@@ -39,9 +41,10 @@ Agents::Agents(const Graph& graph, const size_t agents_num, const size_t seed) {
   agents.reserve(agents_num);
   auto spare_locations = graph.GetSpareLocations();
   ASSERT(spare_locations.size() >= agents_num && "can't place all the agents!");
+  Random random(seed);
   size_t agent_id = 0;
   for (size_t i = 0; i < agents_num; ++i) {
-    size_t rand_idx = rand() % spare_locations.size();
+    size_t rand_idx = random.UniformIndex(spare_locations.size());
     agents.push_back(Agent(spare_locations[rand_idx], agent_id));
     // redo this
     spare_locations.erase(spare_locations.begin() + rand_idx);
@@ -61,12 +64,14 @@ const size_t Agents::GetSize() const {
   return agents.size();
 }
 
-void Agents::UpdateTasksLists(
+std::vector<size_t> Agents::UpdateTasksLists(
     TaskAssigner& task_assigner, const size_t window_size, const Graph& graph) {
-  std::cerr << "updating tasks list : " << std::endl;
+  LOG_DEBUG << "updating tasks list : ";
+  std::vector<size_t> changed_agents;
   for (auto& agent : agents) {
+    const size_t locations_number = agent.locations_to_visit.size();
     // todo: optimize this
-    while (agent.CalculateLowerBound(graph.GetTimeToWaitNearCheckpoints()) < window_size) {
+    while (agent.CalculateLowerBound(graph) < window_size) {
       const auto next_task_opt = task_assigner.GetNextAssignment();
       if (next_task_opt) {
         const Point& start_checkpoint_position =
@@ -85,19 +90,20 @@ void Agents::UpdateTasksLists(
         break;
       }
     }
-    for (const auto& point : agent.locations_to_visit) {
-      std::cerr << point << " ";
+    if (agent.locations_to_visit.size() != locations_number) {
+      changed_agents.push_back(agent.id);
     }
-    std::cerr << std::endl;
+    LOG_DEBUG << MakeLogRange(agent.locations_to_visit);
   }
-  std::cerr << "~~~~~~~" << std::endl;
+  LOG_DEBUG << "~~~~~~~";
+  return changed_agents;
 }
 
 bool Agents::DeleteCompletedTasks(
     const std::vector<std::vector<Point>>& path_prefixes,
     const size_t window_size,
     const size_t time_to_wait_near_checkpoints) {
-  std::cerr << "deleting completed tasks : " << std::endl;
+  LOG_DEBUG << "deleting completed tasks : ";
   bool has_tasks = false;
   for (size_t i = 0; i < path_prefixes.size(); ++i) {
     for (size_t j = 0; j < std::min(window_size, path_prefixes[i].size()); ++j) {
@@ -115,17 +121,42 @@ bool Agents::DeleteCompletedTasks(
       }
       has_tasks |= !agents[i].locations_to_visit.empty();
       if (j + 1 == std::min(window_size, path_prefixes[i].size())) {
-        std::cerr << "old position : " << agents[i].start << std::endl;
+        LOG_DEBUG << "old position : " << agents[i].start;
         agents[i].start = cur_point;
       }
     }
 
-    std::cerr << "new position : " << agents[i].start << std::endl;
-    for (const auto& point : agents[i].locations_to_visit) {
-      std::cerr << point << " ";
-    }
-    std::cerr << std::endl;
+    LOG_DEBUG << "new position : " << agents[i].start;
+    LOG_DEBUG << MakeLogRange(agents[i].locations_to_visit);
   }
-  std::cerr << "~~~~~~~~~" << std::endl;
+  LOG_DEBUG << "~~~~~~~~~";
   return has_tasks;
 }
+
+void Agents::Save(SnapshotWriter& writer) const {
+  writer.Write(agents.size());
+  for (const auto& agent : agents) {
+    writer.Write(agent.start);
+    writer.Write(agent.locations_to_visit);
+    writer.Write(agent.all_checkpoints);
+    writer.Write(agent.all_locations_to_visit);
+    writer.Write(agent.id);
+    writer.Write(agent.waiting_duration_opt);
+  }
+}
+
+void Agents::Load(SnapshotReader& reader) {
+  size_t agents_num = 0;
+  reader.Read(agents_num);
+  agents.clear();
+  for (size_t i = 0; i < agents_num && reader.Good(); ++i) {
+    Agent agent(Point(), 0);
+    reader.Read(agent.start);
+    reader.Read(agent.locations_to_visit);
+    reader.Read(agent.all_checkpoints);
+    reader.Read(agent.all_locations_to_visit);
+    reader.Read(agent.id);
+    reader.Read(agent.waiting_duration_opt);
+    agents.push_back(std::move(agent));
+  }
+}
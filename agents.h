@@ -5,6 +5,7 @@
 
 #include "common.h"
 #include "graph.h"
+#include "snapshot.h"
 #include "task_assigner.h"
 #include "yaml-cpp/yaml.h"
 
@@ -22,7 +23,7 @@ struct Agent {
 
   void PrintDebugInfo(std::ostream& ostream) const;
   // This provides a correct lower bound for an agent to visit all of his active checkpoints
-  size_t CalculateLowerBound(const size_t waiting_duration) const;
+  size_t CalculateLowerBound(const Graph& graph) const;
 };
 
 class Agents {
@@ -35,12 +36,17 @@ public:
   const Agent& At(const size_t index) const;
   const size_t GetSize() const;
 
-  void UpdateTasksLists(TaskAssigner& task_assigner, const size_t window_size, const Graph& graph);
+  // Returns ids of the agents that got new tasks
+  std::vector<size_t> UpdateTasksLists(
+      TaskAssigner& task_assigner, const size_t window_size, const Graph& graph);
   bool DeleteCompletedTasks(
       const std::vector<std::vector<Point>>& path_prefixes,
       const size_t window_size,
       const size_t time_to_wait_near_checkpoints);
 
+  void Save(SnapshotWriter& writer) const;
+  void Load(SnapshotReader& reader);
+
 private:
   std::vector<Agent> agents;
 };
@@ -12,7 +12,56 @@ cxxopts::ParseResult ParseArguments(int argc, char* argv[]) {
       ("c, chains", "Number of assignment chains", cxxopts::value<size_t>()->default_value("3"))
       ("r, checkpoints_ratio", "Eject checkpoints ratio", cxxopts::value<double>()->default_value("0.2"))
       ("e, epochs", "Number of epochs", cxxopts::value<size_t>()->default_value("50"))
-      ("p, entropy", "Entropy of the genetic algorithm", cxxopts::value<double>()->default_value("0.3"));
+      ("p, entropy", "Entropy of the genetic algorithm", cxxopts::value<double>()->default_value("0.3"))
+      ("population", "Number of chromosomes in a generation", cxxopts::value<size_t>()->default_value("3"))
+      ("elites", "Number of best chromosomes carried over unchanged", cxxopts::value<size_t>()->default_value("1"))
+      ("selection", "Parents selection: roulette, tournament or rank",
+          cxxopts::value<std::string>()->default_value("roulette"))
+      ("tournament_size", "Number of chromosomes competing in a tournament selection",
+          cxxopts::value<size_t>()->default_value("2"))
+      ("pairing", "Crossover pairing: all_pairs, random or ring",
+          cxxopts::value<std::string>()->default_value("all_pairs"))
+      ("seed", "Seed of the agents, the assigner chains and the genetic algorithm",
+          cxxopts::value<size_t>()->default_value("42"))
+      ("threads", "Number of worker threads evaluating chromosomes, 0 uses all hardware threads",
+          cxxopts::value<size_t>()->default_value("0"))
+      ("fitness_cache", "File to load layout scores from and save them to, every island gets its own .island_<id> file, empty keeps them in memory only",
+          cxxopts::value<std::string>()->default_value(""))
+      ("racing", "Run assigner chains round by round and drop layouts that can't beat the best one",
+          cxxopts::value<bool>()->default_value("false"))
+      ("racing_confidence", "Standard errors added to the mean throughput before dropping a layout",
+          cxxopts::value<double>()->default_value("2.0"))
+      ("islands", "Number of island processes exchanging their best layouts, 1 disables migration",
+          cxxopts::value<size_t>()->default_value("1"))
+      ("island_id", "Index of this island process, from 0 to islands - 1",
+          cxxopts::value<size_t>()->default_value("0"))
+      ("migration_interval", "Number of epochs between migrations of the islands",
+          cxxopts::value<size_t>()->default_value("10"))
+      ("migration_dir", "Existing directory shared by the island processes",
+          cxxopts::value<std::string>()->default_value("data"))
+      ("snapshot", "Binary file the run state is saved to after every epoch, every island gets its own .island_<id> file, empty disables snapshots",
+          cxxopts::value<std::string>()->default_value(""))
+      ("resume", "Continue the run from the --snapshot file",
+          cxxopts::value<bool>()->default_value("false"))
+      ("multi_objective", "NSGA-II over throughput, kept checkpoints ratio and planner CPU time",
+          cxxopts::value<bool>()->default_value("false"))
+      ("planner", "Low level planner: astar or sipp", cxxopts::value<std::string>()->default_value("astar"))
+      ("conflict_selection", "PBS conflict selection: earliest, random or most_involved",
+          cxxopts::value<std::string>()->default_value("earliest"))
+      ("pbs_search", "PBS high level search: best_first or depth_first",
+          cxxopts::value<std::string>()->default_value("best_first"))
+      ("pbs_threads", "Number of threads of the best-first PBS high level search",
+          cxxopts::value<size_t>()->default_value("1"))
+      ("pbs_deterministic", "Make parallel PBS reproducible by expanding nodes in batches",
+          cxxopts::value<bool>()->default_value("false"))
+      ("pbs_warm_start", "Reuse the previous window's priorities and paths in PBS",
+          cxxopts::value<bool>()->default_value("false"))
+      ("pbs_independent_root", "Plan the agents of a PBS root independently and let the search resolve their conflicts",
+          cxxopts::value<bool>()->default_value("false"))
+      ("astar_horizon", "Resolve constraints in AStar only for this many timesteps, 0 plans full paths",
+          cxxopts::value<size_t>()->default_value("0"))
+      ("log_level", "Log level: none, error, warning, info or debug",
+          cxxopts::value<std::string>()->default_value("info"));
 
   std::vector<std::string> positional_args = {"file"};
   options.parse_positional(positional_args.begin(), positional_args.end());
@@ -0,0 +1,95 @@
+#include "AStar.h"
+#include "agents.h"
+#include "graph.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Heap allocations and time per AStar search for agents that visit a few random reachable
+// cells of a grid without any constraints. Only Graph, Agent and the AStar entry point are
+// used, so the file also builds against older versions of the planner for a before/after
+// comparison.
+//
+// usage: astar_allocations_benchmark <graph file> [searches] [locations per agent]
+
+namespace {
+
+size_t allocations_cnt = 0;
+size_t allocated_bytes = 0;
+
+}
+
+void* operator new(std::size_t size) {
+  ++allocations_cnt;
+  allocated_bytes += size;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 4) {
+    std::cerr << "usage: " << argv[0] << " <graph file> [searches] [locations per agent]" << std::endl;
+    return 1;
+  }
+  const Graph graph(argv[1], 1.0);
+  const size_t searches = argc >= 3 ? std::atoi(argv[2]) : 1000;
+  const size_t locations_cnt = argc >= 4 ? std::atoi(argv[3]) : 3;
+
+  const auto cells = graph.GetSpareLocations();
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<size_t> cell_distribution(0, cells.size() - 1);
+  std::vector<Agent> agents;
+  agents.reserve(searches);
+  for (size_t i = 0; i < searches; ++i) {
+    Agent agent(cells[cell_distribution(generator)], i);
+    // Every location is reachable from the previous one, this also fills the distance tables
+    Point previous_location = agent.start;
+    while (agent.locations_to_visit.size() < locations_cnt) {
+      const Point& location = cells[cell_distribution(generator)];
+      const auto& distances = *graph.GetDistanceTable(location);
+      if (distances[graph.GetCellIndex(previous_location)] != DistancesCache::kUnreachable) {
+        agent.locations_to_visit.push_back(location);
+        previous_location = location;
+      }
+    }
+    agents.push_back(std::move(agent));
+  }
+
+  // The first search sets up the distance tables and the per-thread buffers
+  AStar(agents.front(), {}, {}, graph);
+
+  size_t path_steps = 0;
+  const size_t allocations_start = allocations_cnt;
+  const size_t bytes_start = allocated_bytes;
+  const auto time_start = std::chrono::steady_clock::now();
+  for (const auto& agent : agents) {
+    path_steps += AStar(agent, {}, {}, graph).size();
+  }
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - time_start;
+
+  std::cout << argv[1] << " : " << searches << " searches, "
+            << locations_cnt << " locations per agent, "
+            << static_cast<double>(path_steps) / searches << " steps per path" << std::endl;
+  std::cout << "allocations : " << static_cast<double>(allocations_cnt - allocations_start) / searches
+            << " per search" << std::endl;
+  std::cout << "allocated   : " << static_cast<double>(allocated_bytes - bytes_start) / searches
+            << " bytes per search" << std::endl;
+  std::cout << "time        : " << elapsed.count() / searches << " us per search" << std::endl;
+  return 0;
+}
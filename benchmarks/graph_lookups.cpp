@@ -0,0 +1,107 @@
+#include "graph.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Cost of one neighbours lookup over every free cell of a grid, for the three ways Graph has
+// stored its obstacles: a std::set<Point>, the dense occupancy grid and the precomputed
+// neighbours table that Graph::GetNeighbours reads now.
+//
+// usage: graph_lookups_benchmark <graph file> [repetitions]
+
+namespace {
+
+// Same order as the original GetNeighbours: dx, then dy, from -1 to 1
+constexpr int kMoves[5][2] = {{-1, 0}, {0, -1}, {0, 0}, {0, 1}, {1, 0}};
+
+// Neighbours as the original GetNeighbours built them, a fresh vector on every call
+template <class IsObstacle>
+std::vector<Point> CollectNeighbours(
+    const Point& pos, const int width, const int height, const IsObstacle& is_obstacle) {
+  std::vector<Point> neighbours;
+  for (const auto& move : kMoves) {
+    const Point next(pos.x + move[0], pos.y + move[1]);
+    if (next.x >= 0 && next.x < width && next.y >= 0 && next.y < height && !is_obstacle(next)) {
+      neighbours.push_back(next);
+    }
+  }
+  return neighbours;
+}
+
+template <class Lookup>
+double MeasureLookup(
+    const std::vector<Point>& cells, const size_t repetitions, const Lookup& lookup, size_t& checksum) {
+  checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repetitions; ++i) {
+    for (const auto& cell : cells) {
+      checksum += lookup(cell);
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (repetitions * cells.size());
+}
+
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " <graph file> [repetitions]" << std::endl;
+    return 1;
+  }
+  const Graph graph(argv[1], 1.0);
+  const size_t repetitions = argc == 3 ? std::atoi(argv[2]) : 200;
+  const int width = graph.GetWidth();
+  const int height = graph.GetHeight();
+
+  std::set<Point> obstacles_set;
+  for (int x = 0; x < width; ++x) {
+    for (int y = 0; y < height; ++y) {
+      if (graph.IsObstacle({x, y})) {
+        obstacles_set.insert({x, y});
+      }
+    }
+  }
+  const auto cells = graph.GetSpareLocations();
+
+  // Every lookup folds the neighbours into a number, so that none of them is optimized away.
+  // The neighbours table may list them in another order, so the fold is order independent.
+  const auto fold = [](const auto& neighbours) {
+    size_t result = 0;
+    for (const auto& neighbour : neighbours) {
+      result += static_cast<size_t>(neighbour.x) * 1024 + neighbour.y + 1;
+    }
+    return result;
+  };
+  size_t set_checksum = 0;
+  const double set_ns = MeasureLookup(cells, repetitions, [&](const Point& cell) {
+    return fold(CollectNeighbours(cell, width, height, [&](const Point& pos) {
+      return obstacles_set.count(pos) > 0;
+    }));
+  }, set_checksum);
+  size_t grid_checksum = 0;
+  const double grid_ns = MeasureLookup(cells, repetitions, [&](const Point& cell) {
+    return fold(CollectNeighbours(cell, width, height, [&](const Point& pos) {
+      return graph.IsObstacle(pos);
+    }));
+  }, grid_checksum);
+  size_t table_checksum = 0;
+  const double table_ns = MeasureLookup(cells, repetitions, [&](const Point& cell) {
+    return fold(graph.GetNeighbours(cell));
+  }, table_checksum);
+
+  std::cout << argv[1] << " : " << width << "x" << height << ", "
+            << cells.size() << " free cells, " << repetitions << " repetitions" << std::endl;
+  std::cout << "std::set<Point>  : " << set_ns << " ns per lookup" << std::endl;
+  std::cout << "occupancy grid   : " << grid_ns << " ns per lookup" << std::endl;
+  std::cout << "neighbours table : " << table_ns << " ns per lookup" << std::endl;
+  if (set_checksum != grid_checksum || set_checksum != table_checksum) {
+    std::cout << "Lookups disagree on the neighbours!" << std::endl;
+    return 1;
+  }
+  return 0;
+}
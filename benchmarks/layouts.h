@@ -0,0 +1,41 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Layout of a sorting grid as layout_generation evaluates it: up to a `kept_checkpoints_ratio`
+// share of the induct checkpoints is kept, chosen at random among the ones that keep the grid
+// connected. A random subset of a full grid is almost never connected, so the checkpoints are
+// added one by one and the ones that break the layout are skipped.
+inline Graph MakeBenchmarkLayout(const std::string& filename, const double kept_checkpoints_ratio) {
+  const Graph graph_full(filename, 1.0);
+  if (kept_checkpoints_ratio >= 1.0) {
+    return graph_full;
+  }
+  std::vector<size_t> induct_checkpoints(graph_full.GetInductCheckpoints().size());
+  std::iota(induct_checkpoints.begin(), induct_checkpoints.end(), 0);
+  std::mt19937 generator(42);
+  std::shuffle(induct_checkpoints.begin(), induct_checkpoints.end(), generator);
+  const size_t kept_cnt = std::max<size_t>(1, induct_checkpoints.size() * kept_checkpoints_ratio);
+  std::vector<size_t> kept_checkpoints;
+  Graph graph = graph_full;
+  for (const size_t idx : induct_checkpoints) {
+    if (kept_checkpoints.size() == kept_cnt) {
+      break;
+    }
+    kept_checkpoints.push_back(idx);
+    graph = graph_full;
+    graph.KeepOnlySelectedCheckpoints(kept_checkpoints);
+    if (!graph.IsConnected() || !graph.AllInductCheckpointsAreReachable()) {
+      kept_checkpoints.pop_back();
+    }
+  }
+  graph = graph_full;
+  graph.KeepOnlySelectedCheckpoints(kept_checkpoints);
+  return graph;
+}
@@ -0,0 +1,95 @@
+#include "PBS.h"
+#include "agents.h"
+#include "graph.h"
+#include "layouts.h"
+#include "task_assigner.h"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Time, peak heap and number of generated high level nodes of the windowed PBS for every
+// combination of the root construction and the high level search mode. The layout is built
+// as in planners_benchmark (see layouts.h). Peak heap is the largest amount of memory held at
+// once during the search on top of what was held before it.
+//
+// usage: pbs_search_benchmark <agents> <assignments> <checkpoints ratio> <sorting grid file>...
+
+namespace {
+
+size_t live_bytes = 0;
+size_t peak_live_bytes = 0;
+
+}
+
+void* operator new(std::size_t size) {
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    live_bytes += malloc_usable_size(ptr);
+    peak_live_bytes = std::max(peak_live_bytes, live_bytes);
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  live_bytes -= malloc_usable_size(ptr);
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  live_bytes -= malloc_usable_size(ptr);
+  std::free(ptr);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 5) {
+    std::cerr << "usage: " << argv[0]
+              << " <agents> <assignments> <checkpoints ratio> <sorting grid file>..." << std::endl;
+    return 1;
+  }
+  const size_t agents_cnt = std::atoi(argv[1]);
+  const size_t min_assignments_cnt = std::atoi(argv[2]);
+  const double kept_checkpoints_ratio = std::atof(argv[3]);
+  for (int i = 4; i < argc; ++i) {
+    const Graph graph = MakeBenchmarkLayout(argv[i], kept_checkpoints_ratio);
+    const size_t assignments_cnt = std::max({
+        min_assignments_cnt, graph.GetInductCheckpoints().size(), graph.GetEjectCheckpoints().size()});
+    {
+      // The first search sets up the distance tables and the per-thread AStar buffers
+      TaskAssigner task_assigner(graph, assignments_cnt);
+      Agents agents(graph, agents_cnt);
+      PriorityBasedSearch(agents, graph, task_assigner, 30);
+    }
+    std::cout << argv[i] << " : " << agents_cnt << " agents, " << assignments_cnt << " assignments, "
+              << graph.GetInductCheckpoints().size() << " induct checkpoints" << std::endl;
+    for (const bool independent_root : {false, true}) {
+      for (const auto search_mode : {PBSSearchMode::BestFirst, PBSSearchMode::DepthFirst}) {
+        TaskAssigner task_assigner(graph, assignments_cnt);
+        Agents agents(graph, agents_cnt);
+        PBSParams params;
+        params.search_mode = search_mode;
+        params.independent_root = independent_root;
+
+        const size_t nodes_start = GetPBSGeneratedNodes();
+        const size_t live_bytes_start = live_bytes;
+        peak_live_bytes = live_bytes;
+        const std::clock_t time_start = std::clock();
+        const auto paths = PriorityBasedSearch(agents, graph, task_assigner, 30, params);
+        const double cpu_time = static_cast<double>(std::clock() - time_start) / CLOCKS_PER_SEC;
+
+        std::cout << "  " << (independent_root ? "independent root, " : "prioritized root, ")
+                  << (search_mode == PBSSearchMode::BestFirst ? "best_first  : " : "depth_first : ")
+                  << "throughput " << CalculateThroughput(paths, assignments_cnt)
+                  << ", CPU time " << cpu_time << " s"
+                  << ", generated nodes " << GetPBSGeneratedNodes() - nodes_start
+                  << ", peak heap " << (peak_live_bytes - live_bytes_start) / 1024 << " KiB" << std::endl;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "PBS.h"
+#include "agents.h"
+#include "graph.h"
+#include "layouts.h"
+#include "task_assigner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Wall time of the parallel best-first PBS against the number of its threads, from 1 up to
+// `max threads` (all hardware threads by default) doubling each time. Roots are planned
+// independently, so that the high level search has conflicts to branch on. The layout is built
+// as in planners_benchmark (see layouts.h). Speedups are only meaningful on a machine with
+// at least `max threads` idle cores.
+//
+// usage: pbs_threads_benchmark <agents> <assignments> <checkpoints ratio> <sorting grid file> [max threads]
+
+int main(int argc, char** argv) {
+  if (argc < 5 || argc > 6) {
+    std::cerr << "usage: " << argv[0]
+              << " <agents> <assignments> <checkpoints ratio> <sorting grid file> [max threads]" << std::endl;
+    return 1;
+  }
+  const size_t agents_cnt = std::atoi(argv[1]);
+  const size_t min_assignments_cnt = std::atoi(argv[2]);
+  const double kept_checkpoints_ratio = std::atof(argv[3]);
+  const Graph graph = MakeBenchmarkLayout(argv[4], kept_checkpoints_ratio);
+  const size_t max_threads = argc == 6
+      ? std::atoi(argv[5])
+      : std::max<size_t>(1, std::thread::hardware_concurrency());
+  const size_t assignments_cnt = std::max({
+      min_assignments_cnt, graph.GetInductCheckpoints().size(), graph.GetEjectCheckpoints().size()});
+
+  {
+    // The first search sets up the distance tables
+    TaskAssigner task_assigner(graph, assignments_cnt);
+    Agents agents(graph, agents_cnt);
+    PriorityBasedSearch(agents, graph, task_assigner, 30);
+  }
+  std::cout << argv[4] << " : " << agents_cnt << " agents, " << assignments_cnt << " assignments, "
+            << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+  for (const bool deterministic : {false, true}) {
+    double sequential_time = 0.0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+      TaskAssigner task_assigner(graph, assignments_cnt);
+      Agents agents(graph, agents_cnt);
+      PBSParams params;
+      params.independent_root = true;
+      params.threads = threads;
+      params.deterministic = deterministic;
+
+      const auto time_start = std::chrono::steady_clock::now();
+      const auto paths = PriorityBasedSearch(agents, graph, task_assigner, 30, params);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - time_start;
+      if (threads == 1) {
+        sequential_time = elapsed.count();
+      }
+
+      std::cout << "  " << (deterministic ? "deterministic,    " : "nondeterministic, ")
+                << threads << " threads : "
+                << "throughput " << CalculateThroughput(paths, assignments_cnt)
+                << ", wall time " << elapsed.count() << " s"
+                << ", speedup " << sequential_time / elapsed.count() << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "AStar.h"
+#include "PBS.h"
+#include "SIPP.h"
+#include "agents.h"
+#include "graph.h"
+#include "layouts.h"
+#include "reservation_table.h"
+#include "task_assigner.h"
+
+#include "yaml-cpp/yaml.h"
+
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compares the AStar and SIPP low level planners on every given input:
+// - a sorting grid file is solved by the windowed PBS, as layout_generation evaluates a layout,
+//   with `agents` agents and `assignments` assignments (at least one per kept checkpoint), on
+//   the same layout for both planners
+// - a directory of yaml instances is solved by prioritized planning, every agent plans around
+//   the paths of the agents listed before it, the results are summed over the directory
+//
+// usage: planners_benchmark <agents> <assignments> <checkpoints ratio> <sorting grid file or yaml directory>...
+
+namespace {
+
+struct PlannerResult {
+  size_t expanded_nodes = 0;
+  double cpu_time = 0.0;
+  // Throughput for the sorting grids, number of planned agents for the yaml instances
+  double quality = 0.0;
+};
+
+size_t GetExpandedNodes(const LowLevelPlanner planner) {
+  return planner == LowLevelPlanner::AStar ? GetAStarExpandedNodes() : GetSIPPExpandedNodes();
+}
+
+double GetCPUTime() {
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+PlannerResult RunSortingGrid(
+    const std::string& filename,
+    const size_t agents_cnt,
+    const size_t min_assignments_cnt,
+    const double kept_checkpoints_ratio,
+    const LowLevelPlanner planner) {
+  const Graph graph = MakeBenchmarkLayout(filename, kept_checkpoints_ratio);
+  const size_t assignments_cnt = std::max({
+      min_assignments_cnt, graph.GetInductCheckpoints().size(), graph.GetEjectCheckpoints().size()});
+  TaskAssigner task_assigner(graph, assignments_cnt);
+  Agents agents(graph, agents_cnt);
+  PBSParams params;
+  params.low_level_planner = planner;
+
+  PlannerResult result;
+  const size_t nodes_start = GetExpandedNodes(planner);
+  const double time_start = GetCPUTime();
+  const auto paths = PriorityBasedSearch(agents, graph, task_assigner, 30, params);
+  result.cpu_time = GetCPUTime() - time_start;
+  result.expanded_nodes = GetExpandedNodes(planner) - nodes_start;
+  result.quality = CalculateThroughput(paths, assignments_cnt);
+  return result;
+}
+
+PlannerResult RunYamlInstance(const std::string& filename, const LowLevelPlanner planner) {
+  const YAML::Node yaml_config = YAML::LoadFile(filename);
+  const Graph graph(yaml_config["map"]);
+  std::vector<Agent> agents;
+  for (const auto& yaml_agent : yaml_config["agents"]) {
+    Agent agent(yaml_agent["start"].as<std::pair<int, int>>(), agents.size());
+    agent.locations_to_visit.push_back(yaml_agent["goal"].as<std::pair<int, int>>());
+    agents.push_back(std::move(agent));
+  }
+
+  PlannerResult result;
+  ReservationTable reservation_table(graph);
+  const size_t nodes_start = GetExpandedNodes(planner);
+  const double time_start = GetCPUTime();
+  for (const auto& agent : agents) {
+    const auto path = planner == LowLevelPlanner::AStar
+        ? AStar(agent, {}, {}, graph, std::cref(reservation_table))
+        : SIPP(agent, {}, {}, graph, std::cref(reservation_table));
+    if (!path.empty()) {
+      reservation_table.Reserve(path);
+      ++result.quality;
+    }
+  }
+  result.cpu_time = GetCPUTime() - time_start;
+  result.expanded_nodes = GetExpandedNodes(planner) - nodes_start;
+  return result;
+}
+
+void PrintResult(const std::string& planner_name, const PlannerResult& result) {
+  std::cout << "  " << planner_name
+            << " : expanded nodes " << result.expanded_nodes
+            << ", CPU time " << result.cpu_time << " s"
+            << ", quality " << result.quality << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+  if (argc < 5) {
+    std::cerr << "usage: " << argv[0]
+              << " <agents> <assignments> <checkpoints ratio> <sorting grid file or yaml directory>..." << std::endl;
+    return 1;
+  }
+  const size_t agents_cnt = std::atoi(argv[1]);
+  const size_t assignments_cnt = std::atoi(argv[2]);
+  const double kept_checkpoints_ratio = std::atof(argv[3]);
+  for (int i = 4; i < argc; ++i) {
+    const std::string input = argv[i];
+    PlannerResult astar_result;
+    PlannerResult sipp_result;
+    if (!std::filesystem::is_directory(input)) {
+      std::cout << input << " : PBS, " << agents_cnt << " agents, quality is throughput" << std::endl;
+      astar_result = RunSortingGrid(
+          input, agents_cnt, assignments_cnt, kept_checkpoints_ratio, LowLevelPlanner::AStar);
+      sipp_result = RunSortingGrid(
+          input, agents_cnt, assignments_cnt, kept_checkpoints_ratio, LowLevelPlanner::SIPP);
+    } else {
+      std::vector<std::string> instances;
+      for (const auto& entry : std::filesystem::directory_iterator(input)) {
+        if (entry.path().extension() == ".yaml") {
+          instances.push_back(entry.path().string());
+        }
+      }
+      std::sort(instances.begin(), instances.end());
+      std::cout << input << " : prioritized planning over " << instances.size()
+                << " instances, quality is the number of planned agents" << std::endl;
+      const auto accumulate = [](PlannerResult& total, const PlannerResult& result) {
+        total.expanded_nodes += result.expanded_nodes;
+        total.cpu_time += result.cpu_time;
+        total.quality += result.quality;
+      };
+      for (const auto& instance : instances) {
+        accumulate(astar_result, RunYamlInstance(instance, LowLevelPlanner::AStar));
+        accumulate(sipp_result, RunYamlInstance(instance, LowLevelPlanner::SIPP));
+      }
+    }
+    PrintResult("astar", astar_result);
+    PrintResult("sipp ", sipp_result);
+  }
+  return 0;
+}
@@ -1,7 +1,9 @@
 #include "common.h"
 
+#include "logging.h"
+
 #include <algorithm>
-#include <map>
+#include <cstdint>
 
 Point::Point(const std::pair<int, int>& position)
   : x(position.first)
@@ -61,40 +63,71 @@ std::shared_ptr<ConflictBase> FindFirstConflict(
   if (window_size) {
     max_timestamp = std::min(max_timestamp, window_size.value());
   }
-  std::map<Point, size_t> position_to_agent;
-  std::map<Edge, size_t> edge_to_agent;
+
+  // Cells are indexed densely within the bounding box of the checked path prefixes
+  int width = 0;
+  int height = 0;
+  for (const auto& path : paths) {
+    for (size_t ts = 0; ts < std::min(path.size(), max_timestamp); ++ts) {
+      width = std::max(width, path[ts].x + 1);
+      height = std::max(height, path[ts].y + 1);
+    }
+  }
+  const auto cell_index = [width] (const Point& pos) {
+    return static_cast<size_t>(pos.y) * width + pos.x;
+  };
+
+  // Cell is occupied at the current timestep iff its stamp equals the current generation,
+  // so nothing has to be cleared between timesteps or calls
+  struct CellState {
+    uint32_t stamp = 0;
+    size_t agent_id;
+    Point prev_position;
+  };
+  thread_local std::vector<CellState> cells;
+  thread_local uint32_t generation = 0;
+  if (cells.size() < static_cast<size_t>(width) * height) {
+    cells.resize(static_cast<size_t>(width) * height);
+  }
+
   // todo : ts == 0 breaks the case when one agent is done
   // and another one is trying to go through it. Fix this
   for (size_t ts = 1; ts < max_timestamp; ++ts) {
-    position_to_agent.clear();
-    edge_to_agent.clear();
+    if (++generation == 0) {
+      for (auto& cell : cells) {
+        cell.stamp = 0;
+      }
+      generation = 1;
+    }
     for (size_t agent_id = 0; agent_id < paths.size(); ++agent_id) {
       if (paths[agent_id].size() <= ts) {
         continue;
       }
       const auto agent_pos = paths[agent_id][ts];
-      if (position_to_agent.count(agent_pos)) {
+      const auto prev_pos = paths[agent_id][ts - 1];
+      CellState& cell = cells[cell_index(agent_pos)];
+      if (cell.stamp == generation) {
         // Vertex conflict found
-        std::cerr << "has vertex conflict for : " << agent_id << " and " << position_to_agent.at(agent_pos) << std::endl;
-        std::cerr << "ts: " << ts << std::endl;
-        std::cerr << "vertex : " << agent_pos << std::endl;
+        LOG_DEBUG << "has vertex conflict for : " << agent_id << " and " << cell.agent_id
+            << ", ts: " << ts << ", vertex : " << agent_pos;
         return std::make_shared<VertexConflict>(
-            VertexConflict(position_to_agent.at(agent_pos), agent_id, ts, agent_pos));
+            VertexConflict(cell.agent_id, agent_id, ts, agent_pos));
       }
-      position_to_agent[agent_pos] = agent_id;
-
-      if (ts > 0) {
-        const Edge edge = {paths[agent_id][ts - 1], agent_pos};
-        const Edge rev_edge = {agent_pos, paths[agent_id][ts - 1]};
-        if (edge_to_agent.count(rev_edge)) {
-          // Edge conflict found
-          std::cerr << "has edge conflict for : " << agent_id << " and " << edge_to_agent.at(rev_edge) << std::endl;
-          std::cerr << "ts: " << ts << std::endl;
-          std::cerr << "edge : {" << edge.first << ", " << edge.second << "}" << std::endl;
-          return std::make_shared<EdgeConflict>(
-              EdgeConflict{edge_to_agent.at(rev_edge), agent_id, ts, rev_edge});
-        }
-        edge_to_agent[edge] = agent_id;
+      cell.stamp = generation;
+      cell.agent_id = agent_id;
+      cell.prev_position = prev_pos;
+
+      // Some other agent moves from the current position to the previous one
+      const CellState& prev_cell = cells[cell_index(prev_pos)];
+      if (prev_cell.stamp == generation
+          && prev_cell.agent_id != agent_id
+          && prev_cell.prev_position == agent_pos) {
+        // Edge conflict found
+        const Edge rev_edge = {agent_pos, prev_pos};
+        LOG_DEBUG << "has edge conflict for : " << agent_id << " and " << prev_cell.agent_id
+            << ", ts: " << ts << ", edge : {" << prev_pos << ", " << agent_pos << "}";
+        return std::make_shared<EdgeConflict>(
+            EdgeConflict{prev_cell.agent_id, agent_id, ts, rev_edge});
       }
     }
   }
@@ -35,12 +35,16 @@ std::ostream& operator << (std::ostream& ostream, const Point& point);
 
 using Edge = std::pair<Point, Point>;
 
+// Immutable path that can be shared between several search states
+using SharedPath = std::shared_ptr<const std::vector<Point>>;
+
 size_t CalculateCost(const std::vector<std::vector<Point>>& paths);
 size_t CalculateMaxLength(const std::vector<std::vector<Point>>& paths);
 double CalculateThroughput(const std::vector<std::vector<Point>>& paths, const size_t assignments);
 
 struct ConflictBase;
 
+// Diagnostics about the found conflict are logged at debug level
 std::shared_ptr<ConflictBase> FindFirstConflict(
     const std::vector<std::vector<Point>>& paths,
     const std::optional<size_t>& window_size);
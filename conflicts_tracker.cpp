@@ -0,0 +1,107 @@
+#include "conflicts_tracker.h"
+
+#include <algorithm>
+#include <iterator>
+
+ConflictSelection ParseConflictSelection(const std::string& name) {
+  if (name == "earliest") {
+    return ConflictSelection::Earliest;
+  } else if (name == "random") {
+    return ConflictSelection::Random;
+  } else if (name == "most_involved") {
+    return ConflictSelection::MostInvolved;
+  }
+  std::cout << "Unknown conflict selection strategy : " << name << std::endl;
+  exit(1);
+}
+
+ConflictsTracker::ConflictsTracker(const size_t agents_number)
+  : conflicts_per_agent(agents_number, 0) {}
+
+void ConflictsTracker::Update(
+    const std::vector<SharedPath>& paths,
+    const std::vector<size_t>& changed_agents,
+    const size_t window_size) {
+  std::vector<bool> is_changed(paths.size(), false);
+  for (const size_t agent_id : changed_agents) {
+    is_changed[agent_id] = true;
+  }
+
+  for (auto it = conflicts.begin(); it != conflicts.end();) {
+    const auto& conflict = *it->second;
+    if (is_changed[conflict.agent_1] || is_changed[conflict.agent_2]) {
+      --conflicts_per_agent[conflict.agent_1];
+      --conflicts_per_agent[conflict.agent_2];
+      it = conflicts.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (const size_t changed_agent : changed_agents) {
+    for (size_t other_agent = 0; other_agent < paths.size(); ++other_agent) {
+      if (other_agent == changed_agent
+          || (is_changed[other_agent] && other_agent < changed_agent)) {
+        // Pairs of changed agents are checked once
+        continue;
+      }
+      const size_t agent_1 = std::min(changed_agent, other_agent);
+      const size_t agent_2 = std::max(changed_agent, other_agent);
+      auto conflict = FindPairConflict(*paths[agent_1], *paths[agent_2], agent_1, agent_2, window_size);
+      if (conflict) {
+        ++conflicts_per_agent[agent_1];
+        ++conflicts_per_agent[agent_2];
+        conflicts.emplace(
+            ConflictKey{conflict->ts, agent_2, conflict->conflict_type, agent_1}, std::move(conflict));
+      }
+    }
+  }
+}
+
+bool ConflictsTracker::Empty() const {
+  return conflicts.empty();
+}
+
+size_t ConflictsTracker::Size() const {
+  return conflicts.size();
+}
+
+std::shared_ptr<ConflictBase> ConflictsTracker::Select(
+    const ConflictSelection conflict_selection, Random& generator) const {
+  if (conflicts.empty()) {
+    return nullptr;
+  }
+  if (conflict_selection == ConflictSelection::Random) {
+    return std::next(conflicts.begin(), generator.UniformIndex(conflicts.size()))->second;
+  } else if (conflict_selection == ConflictSelection::MostInvolved) {
+    const size_t agent_id = std::distance(
+        conflicts_per_agent.begin(),
+        std::max_element(conflicts_per_agent.begin(), conflicts_per_agent.end()));
+    for (const auto& [key, conflict] : conflicts) {
+      if (conflict->agent_1 == agent_id || conflict->agent_2 == agent_id) {
+        return conflict;
+      }
+    }
+  }
+  return conflicts.begin()->second;
+}
+
+std::shared_ptr<ConflictBase> ConflictsTracker::FindPairConflict(
+    const std::vector<Point>& lhs_path,
+    const std::vector<Point>& rhs_path,
+    const size_t lhs_agent,
+    const size_t rhs_agent,
+    const size_t window_size) {
+  const size_t max_timestamp = std::min({lhs_path.size(), rhs_path.size(), window_size});
+  // todo : ts == 0 is skipped the same way as in FindFirstConflict
+  for (size_t ts = 1; ts < max_timestamp; ++ts) {
+    if (lhs_path[ts] == rhs_path[ts]) {
+      return std::make_shared<VertexConflict>(lhs_agent, rhs_agent, ts, rhs_path[ts]);
+    }
+    if (lhs_path[ts] == rhs_path[ts - 1] && lhs_path[ts - 1] == rhs_path[ts]) {
+      return std::make_shared<EdgeConflict>(
+          lhs_agent, rhs_agent, ts, Edge{rhs_path[ts], rhs_path[ts - 1]});
+    }
+  }
+  return nullptr;
+}
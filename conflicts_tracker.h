@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+#include "random.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+enum class ConflictSelection {
+  // Same conflict as FindFirstConflict returns
+  Earliest,
+  Random,
+  // Earliest conflict of the agent involved in the most conflicts
+  MostInvolved
+};
+
+ConflictSelection ParseConflictSelection(const std::string& name);
+
+// Earliest conflict of every pair of agents within the window. Only pairs that involve
+// a changed agent are rechecked, so a PBS child node pays for the paths it replanned only.
+class ConflictsTracker {
+public:
+  ConflictsTracker() = default;
+  ConflictsTracker(const size_t agents_number);
+
+  void Update(
+      const std::vector<SharedPath>& paths,
+      const std::vector<size_t>& changed_agents,
+      const size_t window_size);
+
+  bool Empty() const;
+  size_t Size() const;
+  std::shared_ptr<ConflictBase> Select(
+      const ConflictSelection conflict_selection, Random& generator) const;
+
+private:
+  // (ts, agent_2, conflict type, agent_1) orders conflicts the way FindFirstConflict finds them
+  using ConflictKey = std::tuple<size_t, size_t, ConflictType, size_t>;
+
+  static std::shared_ptr<ConflictBase> FindPairConflict(
+      const std::vector<Point>& lhs_path,
+      const std::vector<Point>& rhs_path,
+      const size_t lhs_agent,
+      const size_t rhs_agent,
+      const size_t window_size);
+
+  std::map<ConflictKey, std::shared_ptr<ConflictBase>> conflicts;
+  std::vector<size_t> conflicts_per_agent;
+};
@@ -0,0 +1,57 @@
+#include "distances_cache.h"
+
+#include "graph.h"
+
+#include <algorithm>
+
+DistancesCache::DistancesCache(const size_t capacity_)
+  : capacity(std::max<size_t>(capacity_, 1)) {}
+
+std::shared_ptr<const DistanceTable> DistancesCache::GetDistanceTable(
+    const Graph& graph, const Point& goal) {
+  const size_t goal_cell = graph.GetCellIndex(goal);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    const auto it = goal_to_table.find(goal_cell);
+    if (it != goal_to_table.end()) {
+      tables.splice(tables.begin(), tables, it->second);
+      return it->second->second;
+    }
+  }
+
+  // BFS runs without the lock, concurrent misses on the same goal just compute it twice
+  auto table = BuildDistanceTable(graph, goal);
+
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!goal_to_table.count(goal_cell)) {
+    tables.emplace_front(goal_cell, table);
+    goal_to_table[goal_cell] = tables.begin();
+    if (tables.size() > capacity) {
+      goal_to_table.erase(tables.back().first);
+      tables.pop_back();
+    }
+  }
+  return table;
+}
+
+std::shared_ptr<const DistanceTable> DistancesCache::BuildDistanceTable(
+    const Graph& graph, const Point& goal) {
+  auto table = std::make_shared<DistanceTable>(graph.GetCellsNumber(), kUnreachable);
+  std::vector<Point> queue;
+  queue.reserve(graph.GetCellsNumber());
+  (*table)[graph.GetCellIndex(goal)] = 0;
+  queue.push_back(goal);
+  // Grid moves are symmetric, so BFS from the goal gives distances to the goal
+  for (size_t head = 0; head < queue.size(); ++head) {
+    const Point pos = queue[head];
+    const uint32_t next_distance = (*table)[graph.GetCellIndex(pos)] + 1;
+    for (const auto& neighbour : graph.GetNeighbours(pos, false)) {
+      uint32_t& distance = (*table)[graph.GetCellIndex(neighbour)];
+      if (distance == kUnreachable) {
+        distance = next_distance;
+        queue.push_back(neighbour);
+      }
+    }
+  }
+  return table;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Graph;
+
+// Distances from every cell to one goal cell, indexed by Graph::GetCellIndex
+using DistanceTable = std::vector<uint32_t>;
+
+// Lazily computed reverse-BFS distance tables with LRU eviction.
+// Tables are handed out as shared pointers, so evicting one never invalidates a table
+// that is still being used by a search.
+class DistancesCache {
+public:
+  static constexpr uint32_t kUnreachable = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  DistancesCache(const size_t capacity = kDefaultCapacity);
+
+  std::shared_ptr<const DistanceTable> GetDistanceTable(const Graph& graph, const Point& goal);
+
+private:
+  static std::shared_ptr<const DistanceTable> BuildDistanceTable(
+      const Graph& graph, const Point& goal);
+
+  using LRUList = std::list<std::pair<size_t, std::shared_ptr<const DistanceTable>>>;
+
+  size_t capacity;
+  LRUList tables;
+  std::unordered_map<size_t, LRUList::iterator> goal_to_table;
+  std::mutex mtx;
+};
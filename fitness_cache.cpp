@@ -0,0 +1,158 @@
+#include "fitness_cache.h"
+
+#include "common.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFNVPrime = 1099511628211ULL;
+
+uint64_t HashCombine(const uint64_t seed, const uint64_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}
+
+uint64_t HashFitnessConfig(const std::string& config_description) {
+  uint64_t hash = kFNVOffsetBasis;
+  for (const unsigned char symbol : config_description) {
+    hash ^= symbol;
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+size_t FitnessCache::KeyHasher::operator()(const Key& key) const {
+  uint64_t hash = key.config_hash;
+  for (const size_t checkpoint : key.induct_checkpoints) {
+    hash = HashCombine(hash, checkpoint);
+  }
+  return hash;
+}
+
+FitnessCache::FitnessCache(const uint64_t config_hash_)
+  : config_hash(config_hash_) {}
+
+std::optional<FitnessCache::Entry> FitnessCache::Find(
+    const std::vector<size_t>& sorted_induct_checkpoints) const {
+  ASSERT(std::is_sorted(sorted_induct_checkpoints.begin(), sorted_induct_checkpoints.end())
+      && "Fitness cache key must be sorted");
+  std::lock_guard<std::mutex> lock(mtx);
+  const auto it = entries.find(Key{config_hash, sorted_induct_checkpoints});
+  if (it == entries.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void FitnessCache::Insert(
+    const std::vector<size_t>& sorted_induct_checkpoints, const Entry& entry) {
+  ASSERT(std::is_sorted(sorted_induct_checkpoints.begin(), sorted_induct_checkpoints.end())
+      && "Fitness cache key must be sorted");
+  std::lock_guard<std::mutex> lock(mtx);
+  entries[Key{config_hash, sorted_induct_checkpoints}] = entry;
+}
+
+size_t FitnessCache::Size() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return entries.size();
+}
+
+// One entry per line: config hash, "invalid" or the score, checkpoints count, checkpoints
+// and the CPU time. The last field is missing if the CPU time is unknown.
+void FitnessCache::Load(const std::string& filename) {
+  std::ifstream infile(filename);
+  if (!infile) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mtx);
+  std::string line;
+  while (std::getline(infile, line)) {
+    std::istringstream line_stream(line);
+    Key key;
+    std::string score_str;
+    size_t checkpoints_cnt = 0;
+    if (!(line_stream >> key.config_hash >> score_str >> checkpoints_cnt)) {
+      continue;
+    }
+    key.induct_checkpoints.resize(checkpoints_cnt);
+    for (auto& checkpoint : key.induct_checkpoints) {
+      line_stream >> checkpoint;
+    }
+    if (!line_stream) {
+      continue;
+    }
+    Entry entry;
+    if (score_str != "invalid") {
+      std::istringstream score_stream(score_str);
+      double score = 0.0;
+      if (!(score_stream >> score) || !score_stream.eof()) {
+        continue;
+      }
+      entry.score = score;
+    }
+    double cpu_time = 0.0;
+    if (line_stream >> cpu_time) {
+      entry.cpu_time = cpu_time;
+    }
+    entries[std::move(key)] = entry;
+  }
+}
+
+void FitnessCache::Save(const std::string& filename) const {
+  // Write next to the target and rename, so an interrupted run never leaves a broken file
+  const std::string tmp_filename = filename + ".tmp";
+  {
+    std::ofstream outfile(tmp_filename);
+    outfile.precision(17);
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& [key, entry] : entries) {
+      outfile << key.config_hash << " ";
+      if (entry.score) {
+        outfile << entry.score.value();
+      } else {
+        outfile << "invalid";
+      }
+      outfile << " " << key.induct_checkpoints.size();
+      for (const size_t checkpoint : key.induct_checkpoints) {
+        outfile << " " << checkpoint;
+      }
+      if (entry.cpu_time) {
+        outfile << " " << entry.cpu_time.value();
+      }
+      outfile << "\n";
+    }
+  }
+  std::rename(tmp_filename.c_str(), filename.c_str());
+}
+
+void FitnessCache::Save(SnapshotWriter& writer) const {
+  std::lock_guard<std::mutex> lock(mtx);
+  writer.Write(entries.size());
+  for (const auto& [key, entry] : entries) {
+    writer.Write(key.config_hash);
+    writer.Write(key.induct_checkpoints);
+    writer.Write(entry.score);
+    writer.Write(entry.cpu_time);
+  }
+}
+
+void FitnessCache::Load(SnapshotReader& reader) {
+  std::lock_guard<std::mutex> lock(mtx);
+  size_t entries_cnt = 0;
+  reader.Read(entries_cnt);
+  for (size_t i = 0; i < entries_cnt && reader.Good(); ++i) {
+    Key key;
+    Entry entry;
+    reader.Read(key.config_hash);
+    reader.Read(key.induct_checkpoints);
+    reader.Read(entry.score);
+    reader.Read(entry.cpu_time);
+    entries[std::move(key)] = entry;
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "snapshot.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stable hash of everything besides the layout that affects its fitness
+// (graph file, agents, assigner chains, planner parameters)
+uint64_t HashFitnessConfig(const std::string& config_description);
+
+// Thread-safe memo of layout scores. A layout is identified by its sorted induct
+// checkpoints together with the configuration hash, so entries of other configurations
+// can live in the same file without ever being returned.
+class FitnessCache {
+public:
+  struct Entry {
+    // Not set if the layout is invalid
+    std::optional<double> score;
+    // Average planner CPU time per chain, in seconds. Not set for entries of old files
+    // and for layouts received from other islands.
+    std::optional<double> cpu_time;
+  };
+
+  FitnessCache(const uint64_t config_hash);
+
+  std::optional<Entry> Find(const std::vector<size_t>& sorted_induct_checkpoints) const;
+  void Insert(const std::vector<size_t>& sorted_induct_checkpoints, const Entry& entry);
+  size_t Size() const;
+
+  // Missing file is not an error, the cache just starts empty
+  void Load(const std::string& filename);
+  void Save(const std::string& filename) const;
+  void Save(SnapshotWriter& writer) const;
+  void Load(SnapshotReader& reader);
+
+private:
+  struct Key {
+    uint64_t config_hash;
+    std::vector<size_t> induct_checkpoints;
+
+    bool operator == (const Key& other) const {
+      return config_hash == other.config_hash
+          && induct_checkpoints == other.induct_checkpoints;
+    }
+  };
+
+  struct KeyHasher {
+    size_t operator()(const Key& key) const;
+  };
+
+  uint64_t config_hash;
+  std::unordered_map<Key, Entry, KeyHasher> entries;
+  mutable std::mutex mtx;
+};
@@ -3,19 +3,169 @@
 #include "common.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <random>
-#include <set>
-#include <unordered_set>
+
+namespace {
+
+// Set of checkpoint indices. Stamps make Reset free, so one marker per thread serves
+// every operator call in time linear in the number of marked checkpoints.
+class CheckpointsMarker {
+public:
+  void Reset(const size_t max_checkpoint_idx) {
+    if (stamps.size() < max_checkpoint_idx) {
+      stamps.resize(max_checkpoint_idx, 0);
+    }
+    ++current_stamp;
+    if (current_stamp == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      current_stamp = 1;
+    }
+  }
+  void Mark(const size_t checkpoint) {
+    stamps[checkpoint] = current_stamp;
+  }
+  bool IsMarked(const size_t checkpoint) const {
+    return stamps[checkpoint] == current_stamp;
+  }
+
+private:
+  std::vector<uint32_t> stamps;
+  uint32_t current_stamp = 0;
+};
+
+CheckpointsMarker& GetThreadCheckpointsMarker() {
+  thread_local CheckpointsMarker marker;
+  return marker;
+}
+
+bool HasUniqueCheckpoints(
+    const std::vector<size_t>& checkpoints, const size_t max_checkpoint_idx) {
+  auto& marker = GetThreadCheckpointsMarker();
+  marker.Reset(max_checkpoint_idx);
+  for (const auto checkpoint : checkpoints) {
+    if (marker.IsMarked(checkpoint)) {
+      return false;
+    }
+    marker.Mark(checkpoint);
+  }
+  return true;
+}
+
+// Fronts of the fast non-dominated sort, the first one is the Pareto front
+std::vector<std::vector<size_t>> NonDominatedSort(const std::vector<Objectives>& objectives) {
+  const size_t size = objectives.size();
+  std::vector<std::vector<size_t>> dominated(size);
+  std::vector<size_t> dominators_cnt(size, 0);
+  std::vector<std::vector<size_t>> fronts(1);
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = i + 1; j < size; ++j) {
+      if (Dominates(objectives[i], objectives[j])) {
+        dominated[i].push_back(j);
+        ++dominators_cnt[j];
+      } else if (Dominates(objectives[j], objectives[i])) {
+        dominated[j].push_back(i);
+        ++dominators_cnt[i];
+      }
+    }
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (dominators_cnt[i] == 0) {
+      fronts[0].push_back(i);
+    }
+  }
+  while (!fronts.back().empty()) {
+    std::vector<size_t> next_front;
+    for (const size_t i : fronts.back()) {
+      for (const size_t j : dominated[i]) {
+        if (--dominators_cnt[j] == 0) {
+          next_front.push_back(j);
+        }
+      }
+    }
+    fronts.push_back(std::move(next_front));
+  }
+  fronts.pop_back();
+  return fronts;
+}
+
+// Crowding distance of every member of the front, boundary layouts get infinity
+std::vector<double> CrowdingDistances(
+    const std::vector<Objectives>& objectives, const std::vector<size_t>& front) {
+  std::vector<double> distances(front.size(), 0.0);
+  if (front.size() <= 2) {
+    std::fill(distances.begin(), distances.end(), std::numeric_limits<double>::infinity());
+    return distances;
+  }
+  const std::vector<double Objectives::*> fields = {
+      &Objectives::throughput, &Objectives::kept_ratio, &Objectives::cpu_time};
+  std::vector<size_t> order(front.size());
+  for (const auto field : fields) {
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const size_t lhs, const size_t rhs) {
+      return objectives[front[lhs]].*field < objectives[front[rhs]].*field;
+    });
+    const double min_value = objectives[front[order.front()]].*field;
+    const double max_value = objectives[front[order.back()]].*field;
+    distances[order.front()] = std::numeric_limits<double>::infinity();
+    distances[order.back()] = std::numeric_limits<double>::infinity();
+    if (max_value <= min_value) {
+      continue;
+    }
+    for (size_t i = 1; i + 1 < order.size(); ++i) {
+      distances[order[i]] += (objectives[front[order[i + 1]]].*field
+          - objectives[front[order[i - 1]]].*field) / (max_value - min_value);
+    }
+  }
+  return distances;
+}
+
+}
+
+bool Dominates(const Objectives& lhs, const Objectives& rhs) {
+  const bool not_worse = lhs.throughput >= rhs.throughput
+      && lhs.kept_ratio <= rhs.kept_ratio
+      && lhs.cpu_time <= rhs.cpu_time;
+  const bool better = lhs.throughput > rhs.throughput
+      || lhs.kept_ratio < rhs.kept_ratio
+      || lhs.cpu_time < rhs.cpu_time;
+  return not_worse && better;
+}
+
+SelectionScheme ParseSelectionScheme(const std::string& name) {
+  if (name == "roulette") {
+    return SelectionScheme::Roulette;
+  } else if (name == "tournament") {
+    return SelectionScheme::Tournament;
+  } else if (name == "rank") {
+    return SelectionScheme::Rank;
+  }
+  std::cout << "Unknown selection scheme : " << name << std::endl;
+  exit(1);
+}
+
+PairingStrategy ParsePairingStrategy(const std::string& name) {
+  if (name == "all_pairs") {
+    return PairingStrategy::AllPairs;
+  } else if (name == "random") {
+    return PairingStrategy::Random;
+  } else if (name == "ring") {
+    return PairingStrategy::Ring;
+  }
+  std::cout << "Unknown pairing strategy : " << name << std::endl;
+  exit(1);
+}
 
 void Chromosome::Init(
     const size_t induct_checkpoints_num,
     const double ratio_to_keep,
-    const size_t idx) {
-  const auto iota_and_shuffle = [] (std::vector<size_t>& vec, const size_t size) {
+    const size_t idx,
+    Random& random) {
+  const auto iota_and_shuffle = [&random] (std::vector<size_t>& vec, const size_t size) {
     vec.resize(size);
     std::iota(vec.begin(), vec.end(), 0);
-    std::random_shuffle(vec.begin(), vec.end());
+    random.Shuffle(vec.begin(), vec.end());
   };
 
   iota_and_shuffle(induct_checkpoints_permutation, induct_checkpoints_num);
@@ -24,70 +174,103 @@ void Chromosome::Init(
   this->idx = idx;
 }
 
-void Chromosome::Crossover(const Chromosome& other, const double enthropy) {
-  std::unordered_set<size_t> other_induct_checkpoints(
-      other.induct_checkpoints_permutation.begin(), other.induct_checkpoints_permutation.end());
-  for (const auto& checkpoint_pos : induct_checkpoints_permutation) {
-    other_induct_checkpoints.erase(checkpoint_pos);
+void Chromosome::Crossover(const Chromosome& other, const double enthropy, Random& random) {
+  auto& marker = GetThreadCheckpointsMarker();
+  marker.Reset(std::max(max_checkpoint_idx, other.max_checkpoint_idx));
+  for (const auto checkpoint : induct_checkpoints_permutation) {
+    marker.Mark(checkpoint);
   }
-  if (other_induct_checkpoints.empty()) {
-    return;
+  std::vector<size_t> induct_checkpoints_diff;
+  for (const auto checkpoint : other.induct_checkpoints_permutation) {
+    if (!marker.IsMarked(checkpoint)) {
+      induct_checkpoints_diff.push_back(checkpoint);
+    }
   }
-  std::vector<size_t> induct_checkpoints_diff(
-      other_induct_checkpoints.begin(), other_induct_checkpoints.end());
   for (auto& checkpoint_pos : induct_checkpoints_permutation) {
     if (induct_checkpoints_diff.empty()) {
       break;
     }
-    if (rand() / static_cast<double>(RAND_MAX) < enthropy) {
-      checkpoint_pos = induct_checkpoints_diff[rand() % induct_checkpoints_diff.size()];
-      induct_checkpoints_diff.erase(std::find(
-          induct_checkpoints_diff.begin(), induct_checkpoints_diff.end(), checkpoint_pos));
+    if (random.Bernoulli(enthropy)) {
+      // Swap-remove, the order of the remaining candidates doesn't matter
+      const size_t rand_idx = random.UniformIndex(induct_checkpoints_diff.size());
+      checkpoint_pos = induct_checkpoints_diff[rand_idx];
+      induct_checkpoints_diff[rand_idx] = induct_checkpoints_diff.back();
+      induct_checkpoints_diff.pop_back();
     }
   }
 
-  ASSERT(induct_checkpoints_permutation.size() == std::set<size_t>(
-      induct_checkpoints_permutation.begin(), induct_checkpoints_permutation.end()).size()
+  ASSERT(HasUniqueCheckpoints(induct_checkpoints_permutation, max_checkpoint_idx)
       && "Element after crossover are not unique");
 }
 
-void Chromosome::Mutate(const double enthropy) {
-  MutationSwap(enthropy);
-  MutationShift(enthropy);
+void Chromosome::Mutate(const double enthropy, Random& random) {
+  MutationSwap(random, enthropy);
+  MutationShift(random, enthropy);
 }
 
-void Chromosome::MutationSwap(const double enthropy) {
-  std::unordered_set<size_t> unused_induct_checkpoints;
-  for (size_t i = 0; i < max_checkpoint_idx; ++i) {
-    unused_induct_checkpoints.insert(i);
+void Chromosome::MutationSwap(Random& random, const double enthropy) {
+  auto& marker = GetThreadCheckpointsMarker();
+  marker.Reset(max_checkpoint_idx);
+  for (const auto checkpoint : induct_checkpoints_permutation) {
+    marker.Mark(checkpoint);
   }
-  for (auto checkpoint : induct_checkpoints_permutation) {
-    unused_induct_checkpoints.erase(checkpoint);
+  std::vector<size_t> unused_induct_checkpoints;
+  unused_induct_checkpoints.reserve(max_checkpoint_idx - induct_checkpoints_permutation.size());
+  for (size_t i = 0; i < max_checkpoint_idx; ++i) {
+    if (!marker.IsMarked(i)) {
+      unused_induct_checkpoints.push_back(i);
+    }
   }
 
   for (auto& checkpoint_pos : induct_checkpoints_permutation) {
     if (unused_induct_checkpoints.empty()) {
       break;
     }
-    if (rand() / static_cast<double>(RAND_MAX) < enthropy) {
-      size_t rand_idx = rand() % unused_induct_checkpoints.size();
-      auto rand_it = unused_induct_checkpoints.begin();
-      std::advance(rand_it, rand_idx);
-      const size_t rand_checkpoint = *rand_it;
-      unused_induct_checkpoints.erase(rand_it);
-      unused_induct_checkpoints.insert(checkpoint_pos);
-      checkpoint_pos = rand_checkpoint;
+    if (random.Bernoulli(enthropy)) {
+      const size_t rand_idx = random.UniformIndex(unused_induct_checkpoints.size());
+      std::swap(checkpoint_pos, unused_induct_checkpoints[rand_idx]);
     }
   }
 
-  ASSERT(induct_checkpoints_permutation.size() == std::set<size_t>(
-      induct_checkpoints_permutation.begin(), induct_checkpoints_permutation.end()).size()
+  ASSERT(HasUniqueCheckpoints(induct_checkpoints_permutation, max_checkpoint_idx)
       && "Element after mutate are not unique");
 }
 
-void Chromosome::MutationShift(const double enthropy) {
-  if (rand() / static_cast<double>(RAND_MAX) < enthropy) {
-    const size_t shift = rand() % max_checkpoint_idx;
+void Chromosome::MutationResize(Random& random, const double enthropy, const size_t max_size) {
+  if (!random.Bernoulli(enthropy)) {
+    return;
+  }
+  const size_t size = induct_checkpoints_permutation.size();
+  const bool can_grow = size < std::min(max_size, max_checkpoint_idx);
+  const bool can_shrink = size > 1;
+  if (can_shrink && (!can_grow || random.Bernoulli(0.5))) {
+    const size_t rand_idx = random.UniformIndex(size);
+    induct_checkpoints_permutation[rand_idx] = induct_checkpoints_permutation.back();
+    induct_checkpoints_permutation.pop_back();
+    return;
+  }
+  if (!can_grow) {
+    return;
+  }
+  auto& marker = GetThreadCheckpointsMarker();
+  marker.Reset(max_checkpoint_idx);
+  for (const auto checkpoint : induct_checkpoints_permutation) {
+    marker.Mark(checkpoint);
+  }
+  std::vector<size_t> unused_induct_checkpoints;
+  unused_induct_checkpoints.reserve(max_checkpoint_idx - size);
+  for (size_t i = 0; i < max_checkpoint_idx; ++i) {
+    if (!marker.IsMarked(i)) {
+      unused_induct_checkpoints.push_back(i);
+    }
+  }
+  induct_checkpoints_permutation.push_back(
+      unused_induct_checkpoints[random.UniformIndex(unused_induct_checkpoints.size())]);
+}
+
+void Chromosome::MutationShift(Random& random, const double enthropy) {
+  if (random.Bernoulli(enthropy)) {
+    const size_t shift = random.UniformIndex(max_checkpoint_idx);
     for (auto& checkpoint : induct_checkpoints_permutation) {
       checkpoint = (checkpoint + shift) % max_checkpoint_idx;
     }
@@ -95,62 +278,281 @@ void Chromosome::MutationShift(const double enthropy) {
 }
 
 Generation::Generation(
-      const size_t generation_size,
+      const GenerationParams& params,
       const size_t induct_checkpoints,
       const double kept_checkpoint_ratio,
       const double entropy,
-      const size_t seed) {
-  srand(seed);
-  chromosomes.resize(generation_size);
-  for (size_t i = 0; i < generation_size; ++i) {
-    chromosomes[i].Init(induct_checkpoints, kept_checkpoint_ratio, i);
+      const size_t seed)
+    : params(params)
+    , random(seed) {
+  ASSERT(params.size > 0 && "Generation can't be empty");
+  this->params.elite_cnt = std::min(params.elite_cnt, params.size);
+  chromosomes.resize(params.size);
+  for (size_t i = 0; i < params.size; ++i) {
+    chromosomes[i].Init(induct_checkpoints, kept_checkpoint_ratio, i, random);
   }
 
   this->entropy = entropy;
 }
 
-void Generation::Evolve() {
+void Generation::AcceptMigrant(
+    const std::vector<size_t>& induct_checkpoints, const double score) {
+  if (chromosomes.empty()) {
+    return;
+  }
+  std::vector<size_t> sorted_checkpoints = induct_checkpoints;
+  std::sort(sorted_checkpoints.begin(), sorted_checkpoints.end());
+  for (const auto& chromosome : chromosomes) {
+    auto chromosome_checkpoints = chromosome.induct_checkpoints_permutation;
+    std::sort(chromosome_checkpoints.begin(), chromosome_checkpoints.end());
+    if (chromosome_checkpoints == sorted_checkpoints) {
+      return;
+    }
+  }
+
+  // Invalid chromosomes have no score and go first
+  auto worst_chromosome_it = std::min_element(
+      chromosomes.begin(),
+      chromosomes.end(),
+      [](const Chromosome& lhs, const Chromosome& rhs) {
+    return lhs.score_opt < rhs.score_opt;
+  });
+  worst_chromosome_it->induct_checkpoints_permutation = induct_checkpoints;
+  worst_chromosome_it->score_opt = score;
+}
+
+void Generation::Save(SnapshotWriter& writer) const {
+  const auto save_chromosomes = [&writer](const std::vector<Chromosome>& to_save) {
+    writer.Write(to_save.size());
+    for (const auto& chromosome : to_save) {
+      writer.Write(chromosome.induct_checkpoints_permutation);
+      writer.Write(chromosome.score_opt);
+      writer.Write(chromosome.objectives_opt);
+      writer.Write(chromosome.max_checkpoint_idx);
+      writer.Write(chromosome.idx);
+    }
+  };
+  save_chromosomes(chromosomes);
+  save_chromosomes(parents);
+  writer.Write(entropy);
+  random.Save(writer);
+}
+
+void Generation::Load(SnapshotReader& reader) {
+  const auto load_chromosomes = [&reader](std::vector<Chromosome>& to_load) {
+    size_t chromosomes_cnt = 0;
+    reader.Read(chromosomes_cnt);
+    to_load.clear();
+    for (size_t i = 0; i < chromosomes_cnt && reader.Good(); ++i) {
+      Chromosome chromosome;
+      reader.Read(chromosome.induct_checkpoints_permutation);
+      reader.Read(chromosome.score_opt);
+      reader.Read(chromosome.objectives_opt);
+      reader.Read(chromosome.max_checkpoint_idx);
+      reader.Read(chromosome.idx);
+      to_load.push_back(std::move(chromosome));
+    }
+  };
+  load_chromosomes(chromosomes);
+  load_chromosomes(parents);
+  reader.Read(entropy);
+  random.Load(reader);
+}
+
+std::vector<size_t> Generation::SelectParents(const size_t parents_cnt) {
   std::vector<double> scores;
   scores.reserve(chromosomes.size());
   for (const auto& chromosome : chromosomes) {
     scores.push_back(chromosome.IsInvalid() ? 0.0 : chromosome.score_opt.value());
   }
-  // for (const auto& chromosome : chromosomes) {
-  //   std::cout << (chromosome.IsInvalid() ? 0.0 : chromosome.score_opt.value()) << " ";
-  // }
-  // std::cout << std::endl;
 
-  std::default_random_engine generator;
-  std::discrete_distribution<int> distribution(scores.begin(), scores.end());
+  std::vector<size_t> parents;
+  parents.reserve(parents_cnt);
+  if (params.selection == SelectionScheme::Tournament) {
+    for (size_t i = 0; i < parents_cnt; ++i) {
+      size_t winner = random.UniformIndex(scores.size());
+      for (size_t j = 1; j < params.tournament_size; ++j) {
+        const size_t contender = random.UniformIndex(scores.size());
+        if (scores[contender] > scores[winner]) {
+          winner = contender;
+        }
+      }
+      parents.push_back(winner);
+    }
+    return parents;
+  }
+
+  std::vector<double> weights = scores;
+  if (params.selection == SelectionScheme::Rank) {
+    std::vector<size_t> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&scores](const size_t lhs, const size_t rhs) {
+      return scores[lhs] < scores[rhs];
+    });
+    for (size_t rank = 0; rank < order.size(); ++rank) {
+      weights[order[rank]] = rank + 1;
+    }
+  }
+  // All layouts are invalid, any of them is as good as the other
+  if (std::all_of(weights.begin(), weights.end(), [](const double w) { return w <= 0.0; })) {
+    std::fill(weights.begin(), weights.end(), 1.0);
+  }
+  std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+  for (size_t i = 0; i < parents_cnt; ++i) {
+    parents.push_back(distribution(random));
+  }
+  return parents;
+}
+
+void Generation::Reproduce(Generation& new_generation) const {
+  auto& offspring = new_generation.chromosomes;
+  for (auto& chromosome : offspring) {
+    chromosome.Mutate(entropy, new_generation.random);
+    if (params.multi_objective) {
+      chromosome.MutationResize(new_generation.random, entropy, params.max_kept_checkpoints);
+    }
+  }
+  if (params.pairing == PairingStrategy::AllPairs) {
+    for (auto& chromosome : offspring) {
+      for (const auto& other_chromosome : offspring) {
+          chromosome.Crossover(other_chromosome, entropy, new_generation.random);
+      }
+    }
+  } else if (params.pairing == PairingStrategy::Random) {
+    for (auto& chromosome : offspring) {
+      const size_t partner = new_generation.random.UniformIndex(offspring.size());
+      chromosome.Crossover(offspring[partner], entropy, new_generation.random);
+    }
+  } else if (params.pairing == PairingStrategy::Ring) {
+    for (size_t i = 0; i + 1 < offspring.size(); ++i) {
+      offspring[i].Crossover(offspring[i + 1], entropy, new_generation.random);
+    }
+    if (offspring.size() > 1) {
+      offspring.back().Crossover(offspring.front(), entropy, new_generation.random);
+    }
+  }
+}
+
+void Generation::Evolve() {
+  if (params.multi_objective) {
+    EvolveMultiObjective();
+    return;
+  }
+  const auto selected = SelectParents(chromosomes.size() - params.elite_cnt);
   Generation new_generation;
+  new_generation.params = params;
   new_generation.entropy = entropy;
-  while (new_generation.chromosomes.size() + 1 < chromosomes.size()) {
-    new_generation.chromosomes.push_back(chromosomes[distribution(generator)]);
+  new_generation.random = random;
+  for (const size_t parent : selected) {
+    new_generation.chromosomes.push_back(chromosomes[parent]);
   }
+  Reproduce(new_generation);
 
-  for (auto& chromosome : new_generation.chromosomes) {
-    chromosome.Mutate(entropy);
+  // This guarantees that the best chromosomes stay in generation
+  std::vector<size_t> order(chromosomes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](const size_t lhs, const size_t rhs) {
+    return chromosomes[lhs].score_opt > chromosomes[rhs].score_opt;
+  });
+  for (size_t i = 0; i < params.elite_cnt; ++i) {
+    new_generation.chromosomes.push_back(chromosomes[order[i]]);
+  }
+  *this = std::move(new_generation);
+  for (size_t i = 0; i < chromosomes.size(); ++i) {
+    chromosomes[i].idx = i;
   }
-  for (auto& chromosome : new_generation.chromosomes) {
-    for (const auto& other_chromosome : new_generation.chromosomes) {
-        chromosome.Crossover(other_chromosome, entropy);
+}
+
+// NSGA-II: the evaluated offspring compete with their parents, the next parents are
+// taken front by front and the last front that doesn't fit is cut by crowding distance
+void Generation::EvolveMultiObjective() {
+  std::vector<Chromosome> candidates;
+  std::vector<Chromosome> invalid_candidates;
+  for (auto* population : {&parents, &chromosomes}) {
+    for (auto& chromosome : *population) {
+      if (chromosome.objectives_opt) {
+        candidates.push_back(std::move(chromosome));
+      } else {
+        invalid_candidates.push_back(std::move(chromosome));
+      }
     }
   }
+  std::vector<Objectives> objectives;
+  objectives.reserve(candidates.size());
+  for (const auto& candidate : candidates) {
+    objectives.push_back(candidate.objectives_opt.value());
+  }
 
-  // This guarantees that the best chromosome stays in generation
-  const auto best_chromosome_it = std::max_element(
-      chromosomes.begin(),
-      chromosomes.end(),
-      [](const Chromosome& lhs, const Chromosome& rhs) {
-    return lhs.score_opt < rhs.score_opt;
-  });
-  new_generation.chromosomes.push_back(*best_chromosome_it);
-  // for (const auto& c : new_generation.chromosomes.back().induct_checkpoints_permutation) {
-  //   std::cout << c << " ";
-  // }
-  // std::cout << std::endl;
+  std::vector<Chromosome> next_parents;
+  // Rank and crowding distance of every next parent for the tournament
+  std::vector<std::pair<size_t, double>> fitness;
+  const auto fronts = NonDominatedSort(objectives);
+  for (size_t rank = 0; rank < fronts.size() && next_parents.size() < params.size; ++rank) {
+    const auto& front = fronts[rank];
+    const auto distances = CrowdingDistances(objectives, front);
+    std::vector<size_t> order(front.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&distances](const size_t lhs, const size_t rhs) {
+      return distances[lhs] > distances[rhs];
+    });
+    for (size_t i = 0; i < order.size() && next_parents.size() < params.size; ++i) {
+      next_parents.push_back(std::move(candidates[front[order[i]]]));
+      fitness.emplace_back(rank, distances[order[i]]);
+    }
+  }
+  for (auto& chromosome : invalid_candidates) {
+    if (next_parents.size() == params.size) {
+      break;
+    }
+    next_parents.push_back(std::move(chromosome));
+    fitness.emplace_back(fronts.size(), 0.0);
+  }
+
+  // Lower rank wins, a larger crowding distance breaks ties
+  const auto is_better = [&fitness](const size_t lhs, const size_t rhs) {
+    return fitness[lhs].first < fitness[rhs].first
+        || (fitness[lhs].first == fitness[rhs].first && fitness[lhs].second > fitness[rhs].second);
+  };
+  Generation new_generation;
+  for (size_t i = 0; i < params.size; ++i) {
+    size_t winner = random.UniformIndex(next_parents.size());
+    for (size_t j = 1; j < params.tournament_size; ++j) {
+      const size_t contender = random.UniformIndex(next_parents.size());
+      if (is_better(contender, winner)) {
+        winner = contender;
+      }
+    }
+    new_generation.chromosomes.push_back(next_parents[winner]);
+    new_generation.chromosomes.back().Invalidate();
+  }
+  new_generation.params = params;
+  new_generation.entropy = entropy;
+  new_generation.random = random;
+  Reproduce(new_generation);
+  new_generation.parents = std::move(next_parents);
   *this = std::move(new_generation);
   for (size_t i = 0; i < chromosomes.size(); ++i) {
     chromosomes[i].idx = i;
   }
 }
+
+std::vector<Chromosome> Generation::GetParetoFront() const {
+  const auto& population = parents.empty() ? chromosomes : parents;
+  std::vector<Objectives> objectives;
+  std::vector<const Chromosome*> valid_chromosomes;
+  for (const auto& chromosome : population) {
+    if (chromosome.objectives_opt) {
+      objectives.push_back(chromosome.objectives_opt.value());
+      valid_chromosomes.push_back(&chromosome);
+    }
+  }
+  std::vector<Chromosome> front;
+  if (objectives.empty()) {
+    return front;
+  }
+  const auto fronts = NonDominatedSort(objectives);
+  for (const size_t i : fronts.front()) {
+    front.push_back(*valid_chromosomes[i]);
+  }
+  return front;
+}
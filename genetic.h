@@ -1,21 +1,82 @@
 #pragma once
 
+#include "random.h"
+#include "snapshot.h"
+
+#include <limits>
 #include <optional>
+#include <string>
 #include <vector>
 
+enum class SelectionScheme {
+  // Probability proportional to the score
+  Roulette,
+  // Best of tournament_size uniformly drawn chromosomes
+  Tournament,
+  // Probability proportional to the position in the order by score
+  Rank
+};
+
+SelectionScheme ParseSelectionScheme(const std::string& name);
+
+enum class PairingStrategy {
+  // Every offspring crosses with every other one
+  AllPairs,
+  // Every offspring crosses with one uniformly drawn offspring
+  Random,
+  // Offspring i crosses with offspring i + 1, the last one with the first
+  Ring
+};
+
+PairingStrategy ParsePairingStrategy(const std::string& name);
+
+// Objectives of the multi-objective mode. Throughput is maximized, the share of kept
+// induct checkpoints and the planner CPU time are minimized.
+struct Objectives {
+  double throughput;
+  double kept_ratio;
+  double cpu_time;
+};
+
+// True if lhs is not worse than rhs in any objective and better in at least one
+bool Dominates(const Objectives& lhs, const Objectives& rhs);
+
+struct GenerationParams {
+  size_t size = 3;
+  // The best chromosomes are carried over to the next generation unchanged
+  size_t elite_cnt = 1;
+  SelectionScheme selection = SelectionScheme::Roulette;
+  size_t tournament_size = 2;
+  PairingStrategy pairing = PairingStrategy::AllPairs;
+  // NSGA-II over Objectives instead of the throughput alone. Chromosomes may then
+  // change the number of kept checkpoints, up to max_kept_checkpoints.
+  bool multi_objective = false;
+  size_t max_kept_checkpoints = std::numeric_limits<size_t>::max();
+};
+
 class Chromosome {
   friend class Generation;
 
  public:
-  void Init(const size_t induct_checkpoints_num, const double ratio_to_keep, const size_t idx);
+  void Init(
+      const size_t induct_checkpoints_num,
+      const double ratio_to_keep,
+      const size_t idx,
+      Random& random);
 
-  void Crossover(const Chromosome& other, const double enthropy);
-  void Mutate(const double enthropy);
+  void Crossover(const Chromosome& other, const double enthropy, Random& random);
+  void Mutate(const double enthropy, Random& random);
   void SetScore(const double score) {
     score_opt = score;
   }
+  // The score stays the throughput, so both modes share the single objective code
+  void SetObjectives(const Objectives& objectives) {
+    score_opt = objectives.throughput;
+    objectives_opt = objectives;
+  }
   void Invalidate() {
     score_opt = std::nullopt;
+    objectives_opt = std::nullopt;
   }
   bool IsInvalid() const {
     return !score_opt.has_value();
@@ -24,13 +85,19 @@ class Chromosome {
   std::vector<size_t> GetCheckpointsPermutation() const {
     return induct_checkpoints_permutation;
   }
+  const std::optional<Objectives>& GetObjectives() const {
+    return objectives_opt;
+  }
 
  private:
-  void MutationSwap(const double enthropy = 0.3);
-  void MutationShift(const double enthropy = 0.3);
+  void MutationSwap(Random& random, const double enthropy = 0.3);
+  void MutationShift(Random& random, const double enthropy = 0.3);
+  // Adds or removes one checkpoint, keeping between 1 and max_size of them
+  void MutationResize(Random& random, const double enthropy, const size_t max_size);
 
   std::vector<size_t> induct_checkpoints_permutation;
   std::optional<double> score_opt;
+  std::optional<Objectives> objectives_opt;
   size_t max_checkpoint_idx;
   size_t idx;
 };
@@ -39,7 +106,7 @@ class Generation {
 public:
   Generation() = default;
   Generation(
-      const size_t generation_size,
+      const GenerationParams& params,
       const size_t induct_checkpoints_num,
       const double kept_checkpoint_ratio,
       const double entropy,
@@ -53,8 +120,26 @@ public:
   }
 
   void Evolve();
+  // Non-dominated layouts among the current parents of the multi-objective mode
+  std::vector<Chromosome> GetParetoFront() const;
+  // Replaces the worst chromosome with an already scored one from another population,
+  // unless the population already has it
+  void AcceptMigrant(const std::vector<size_t>& induct_checkpoints, const double score);
+
+  // Chromosomes with their scores, the entropy and the RNG state
+  void Save(SnapshotWriter& writer) const;
+  void Load(SnapshotReader& reader);
 
 private:
+  std::vector<size_t> SelectParents(const size_t parents_cnt);
+  void EvolveMultiObjective();
+  // Mutation and crossover of the selected parents
+  void Reproduce(Generation& new_generation) const;
+
   std::vector<Chromosome> chromosomes;
+  // Evaluated parents that the offspring in chromosomes compete with, multi-objective only
+  std::vector<Chromosome> parents;
+  GenerationParams params;
   double entropy;
+  Random random;
 };
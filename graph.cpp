@@ -1,24 +1,31 @@
 #include "graph.h"
 
+#include "random.h"
+
 #include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <set>
 
 Graph::Graph(const YAML::Node& yaml_graph) {
   width = yaml_graph["dimensions"].as<std::pair<int, int>>().first;
   height = yaml_graph["dimensions"].as<std::pair<int, int>>().second;
+  ResetObstacles();
   for (const auto& obstacle : yaml_graph["obstacles"]) {
-    obstacles.insert(Point{obstacle.as<std::pair<int, int>>()});
+    SetObstacle(Point{obstacle.as<std::pair<int, int>>()});
   }
+  BuildNeighboursTable();
 }
 
-Graph::Graph(const std::string& filename, const double deleted_eject_checkpoints_ratio) {
+Graph::Graph(
+    const std::string& filename,
+    const double deleted_eject_checkpoints_ratio,
+    const size_t seed) {
   std::ifstream graph_file(filename);
   std::string line;
   std::getline(graph_file, line);
   width = std::stoi(line.substr(0, line.find(',')));
   height = std::stoi(line.substr(line.find(',') + 1, line.size()));
+  ResetObstacles();
   while (std::getline(graph_file, line)) {
     std::vector<std::string> tokens;
     size_t start = 0;
@@ -31,11 +38,11 @@ Graph::Graph(const std::string& filename, const double deleted_eject_checkpoints
     ASSERT(tokens.size() == 9 && "tokens number is incorrect");
     Point current_point(std::stoi(tokens[3]), std::stoi(tokens[4]));
     if (tokens[1] == "Obstacle") {
-      obstacles.insert(current_point);
+      SetObstacle(current_point);
     } else if (tokens[1] == "Eject") {
       eject_checkpoints.push_back(current_point);
     } else if (tokens[1] == "Induct") {
-      obstacles.insert(current_point);
+      SetObstacle(current_point);
       induct_checkpoints.push_back(current_point);
     } else if (tokens[1] == "Travel") {
       // pass
@@ -47,7 +54,8 @@ Graph::Graph(const std::string& filename, const double deleted_eject_checkpoints
   if (deleted_eject_checkpoints_ratio < 1.0) {
     std::vector<size_t> kept_eject_checkpoints_idx(eject_checkpoints.size());
     std::iota(kept_eject_checkpoints_idx.begin(), kept_eject_checkpoints_idx.end(), 0);
-    std::random_shuffle(kept_eject_checkpoints_idx.begin(), kept_eject_checkpoints_idx.end());
+    Random random(seed);
+    random.Shuffle(kept_eject_checkpoints_idx.begin(), kept_eject_checkpoints_idx.end());
     kept_eject_checkpoints_idx.resize(
         kept_eject_checkpoints_idx.size() * deleted_eject_checkpoints_ratio);
     std::vector<Point> eject_checkpoints_tmp = std::move(eject_checkpoints);
@@ -57,6 +65,7 @@ Graph::Graph(const std::string& filename, const double deleted_eject_checkpoints
       eject_checkpoints.push_back(eject_checkpoints_tmp[kept_eject_checkpoints_idx[i]]);
     }
   }
+  BuildNeighboursTable();
 }
 
 const std::vector<Point>& Graph::GetEjectCheckpoints() const {
@@ -69,10 +78,10 @@ const std::vector<Point>& Graph::GetInductCheckpoints() const {
 
 const std::vector<Point> Graph::GetSpareLocations() const {
   std::vector<Point> result;
-  result.reserve(width * height - obstacles.size());
+  result.reserve(GetCellsNumber() - obstacles_cnt);
   for (int i = 0; i < width; ++i) {
     for (int j = 0; j < height; ++j) {
-      if (!obstacles.count({i, j})) {
+      if (!IsObstacle({i, j})) {
         result.push_back({i, j});
       }
     }
@@ -80,40 +89,65 @@ const std::vector<Point> Graph::GetSpareLocations() const {
   return result;
 }
 
-std::vector<Point> Graph::GetNeighbours(const Point& pos, const bool with_pos) const {
-  std::vector<Point> neighbours;
-  for (const int dx : {-1, 0, 1}) {
-    for (const int dy : {-1, 0, 1}) {
-      if (abs(dx) + abs(dy) <= 1
-          && pos.x + dx < width && pos.x + dx >= 0
-          && pos.y + dy < height && pos.y + dy >= 0
-          && !obstacles.count(Point{pos.x + dx, pos.y + dy})
-          && (with_pos || abs(dx) + abs(dy) == 1)) {
-        neighbours.push_back(Point{pos.x + dx, pos.y + dy});
-      }
-    }
-  }
-  return neighbours;
+NeighboursRange Graph::GetNeighbours(const Point& pos, const bool with_pos) const {
+  const size_t cell = GetCellIndex(pos);
+  const Point* first = neighbours.data() + neighbours_offsets[cell];
+  const Point* last = neighbours.data() + neighbours_offsets[cell + 1];
+  const Point* skip =
+      (with_pos || neighbours_self[cell] == kNoSelf) ? nullptr : first + neighbours_self[cell];
+  return NeighboursRange(first, last, skip);
 }
 
 std::optional<Point> Graph::GetAnyNearSpareLocation(const Point& pos) const {
-  const std::vector<Point> neighbours = GetNeighbours(pos, false);
-  if (neighbours.empty()) {
+  const auto near_locations = GetNeighbours(pos, false);
+  if (near_locations.empty()) {
     return std::nullopt;
   } else {
     // This is done for the sake of reproducibility
-    return neighbours.front();
+    return near_locations.front();
   }
 }
 
+bool Graph::IsObstacle(const Point& pos) const {
+  return obstacles[GetCellIndex(pos)];
+}
+
+size_t Graph::GetCellIndex(const Point& pos) const {
+  return static_cast<size_t>(pos.y) * width + pos.x;
+}
+
+size_t Graph::GetCellsNumber() const {
+  return static_cast<size_t>(width) * height;
+}
+
+int Graph::GetWidth() const {
+  return width;
+}
+
+int Graph::GetHeight() const {
+  return height;
+}
+
+size_t Graph::GetDistance(const Point& from, const Point& to) const {
+  const uint32_t distance = (*GetDistanceTable(to))[GetCellIndex(from)];
+  if (distance == DistancesCache::kUnreachable) {
+    return std::abs(from.x - to.x) + std::abs(from.y - to.y);
+  }
+  return distance;
+}
+
+std::shared_ptr<const DistanceTable> Graph::GetDistanceTable(const Point& goal) const {
+  return distances_cache->GetDistanceTable(*this, goal);
+}
+
 size_t Graph::GetTimeToWaitNearCheckpoints() const {
   return time_to_wait_near_checkpoints;
 }
 
 void Graph::ShuffleCheckpoints(const size_t seed) {
-  srand(seed);
-  std::random_shuffle(eject_checkpoints.begin(), eject_checkpoints.end());
-  std::random_shuffle(induct_checkpoints.begin(), induct_checkpoints.end());
+  Random random(seed);
+  random.Shuffle(eject_checkpoints.begin(), eject_checkpoints.end());
+  random.Shuffle(induct_checkpoints.begin(), induct_checkpoints.end());
 }
 
 void Graph::ApplyPermutation(
@@ -137,14 +171,16 @@ void Graph::ApplyPermutation(
 
 void Graph::SetInductCheckpointsAsObstacles(const std::vector<Assignment>& assignments) {
   for (const auto& assignment : assignments) {
-    obstacles.insert(induct_checkpoints[assignment.finish_checkpoint_idx]);
+    SetObstacle(induct_checkpoints[assignment.finish_checkpoint_idx]);
   }
+  BuildNeighboursTable();
 }
 
 void Graph::SetEjectCheckpointsAsObstacles(const std::vector<Assignment>& assignments) {
   for (const auto& assignment : assignments) {
-    obstacles.insert(eject_checkpoints[assignment.finish_checkpoint_idx]);
+    SetObstacle(eject_checkpoints[assignment.finish_checkpoint_idx]);
   }
+  BuildNeighboursTable();
 }
 
 void Graph::KeepOnlySelectedCheckpoints(const std::vector<size_t>& induct_checkpoint_indices) {
@@ -154,19 +190,20 @@ void Graph::KeepOnlySelectedCheckpoints(const std::vector<size_t>& induct_checkp
   for (const auto idx : induct_checkpoint_indices) {
     induct_checkpoints.push_back(induct_checkpoints_tmp[idx]);
   }
-  obstacles.clear();
+  ResetObstacles();
   for (const auto& induct_checkpoint : induct_checkpoints) {
-    obstacles.insert(induct_checkpoint);
+    SetObstacle(induct_checkpoint);
   }
+  BuildNeighboursTable();
 }
 
 bool Graph::IsConnected() const {
   bool dfs_was_run = false;
-  std::set<Point> used;
+  std::vector<bool> used(GetCellsNumber(), false);
   for (size_t i = 0; i < width; ++i) {
     for (size_t j = 0; j < height; ++j) {
       Point pos(i, j);
-      if (!obstacles.count(pos) && !used.count(pos)) {
+      if (!IsObstacle(pos) && !used[GetCellIndex(pos)]) {
         if (!dfs_was_run) {
           DFS(pos, used);
           dfs_was_run = true;
@@ -183,7 +220,7 @@ bool Graph::AllInductCheckpointsAreReachable() const {
   for (const auto& induct_checkpoint : induct_checkpoints) {
     bool checkpoint_is_reachable = false;
     for (const auto& neighbour : GetNeighbours(induct_checkpoint, false)) {
-      if (!obstacles.count(neighbour)) {
+      if (!IsObstacle(neighbour)) {
         checkpoint_is_reachable = true;
         break;
       }
@@ -195,11 +232,54 @@ bool Graph::AllInductCheckpointsAreReachable() const {
   return true;
 }
 
-void Graph::DFS(const Point& pos, std::set<Point>& used) const {
-  used.insert(pos);
+void Graph::DFS(const Point& pos, std::vector<bool>& used) const {
+  used[GetCellIndex(pos)] = true;
   for (const auto& neighbour : GetNeighbours(pos, false)) {
-    if (!used.count(neighbour)) {
+    if (!used[GetCellIndex(neighbour)]) {
       DFS(neighbour, used);
     }
   }
+}
+
+void Graph::ResetObstacles() {
+  obstacles.assign(GetCellsNumber(), 0);
+  obstacles_cnt = 0;
+}
+
+void Graph::SetObstacle(const Point& pos) {
+  uint8_t& cell = obstacles[GetCellIndex(pos)];
+  obstacles_cnt += !cell;
+  cell = 1;
+}
+
+void Graph::BuildNeighboursTable() {
+  const size_t cells_number = GetCellsNumber();
+  neighbours_offsets.assign(cells_number + 1, 0);
+  neighbours_self.assign(cells_number, kNoSelf);
+  neighbours.clear();
+  neighbours.reserve(5 * (cells_number - obstacles_cnt));
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const Point pos(x, y);
+      const size_t cell = GetCellIndex(pos);
+      neighbours_offsets[cell] = neighbours.size();
+      // Keep the historical {dx, dy} order, it defines tie-breaking in AStar
+      for (const int dx : {-1, 0, 1}) {
+        for (const int dy : {-1, 0, 1}) {
+          const Point neighbour(x + dx, y + dy);
+          if (abs(dx) + abs(dy) <= 1
+              && neighbour.x < width && neighbour.x >= 0
+              && neighbour.y < height && neighbour.y >= 0
+              && !IsObstacle(neighbour)) {
+            if (dx == 0 && dy == 0) {
+              neighbours_self[cell] = neighbours.size() - neighbours_offsets[cell];
+            }
+            neighbours.push_back(neighbour);
+          }
+        }
+      }
+    }
+  }
+  neighbours_offsets[cells_number] = neighbours.size();
+  distances_cache = std::make_shared<DistancesCache>();
 }
\ No newline at end of file
@@ -1,23 +1,90 @@
 #pragma once
 
-#include <set>
+#include <cstdint>
+#include <limits>
 #include <utility>
 
 #include "common.h"
+#include "distances_cache.h"
 #include "yaml-cpp/yaml.h"
 
+// Non-allocating view over the neighbours of one cell in the Graph's adjacency table.
+// The cell itself (waiting in place) is skipped unless it was requested.
+class NeighboursRange {
+public:
+  class Iterator {
+  public:
+    Iterator(const Point* ptr_, const Point* skip_)
+      : ptr(ptr_)
+      , skip(skip_) {}
+
+    const Point& operator * () const {
+      return *ptr;
+    }
+    Iterator& operator ++ () {
+      ++ptr;
+      if (ptr == skip) {
+        ++ptr;
+      }
+      return *this;
+    }
+    bool operator != (const Iterator& other) const {
+      return ptr != other.ptr;
+    }
+
+  private:
+    const Point* ptr;
+    const Point* skip;
+  };
+
+  NeighboursRange(const Point* first_, const Point* last_, const Point* skip_)
+    : first(first_ == skip_ ? first_ + 1 : first_)
+    , last(last_)
+    , skip(skip_) {}
+
+  Iterator begin() const {
+    return Iterator(first, skip);
+  }
+  Iterator end() const {
+    return Iterator(last, skip);
+  }
+  bool empty() const {
+    return first == last;
+  }
+  const Point& front() const {
+    return *first;
+  }
+
+private:
+  const Point* first;
+  const Point* last;
+  const Point* skip;
+};
+
 class Graph {
 public:
   Graph() = default;
   Graph(const YAML::Node& yaml_graph);
-  Graph(const std::string& filename, const double deleted_eject_checkpoints_ratio);
+  Graph(
+      const std::string& filename,
+      const double deleted_eject_checkpoints_ratio,
+      const size_t seed = 42);
 
   const std::vector<Point>& GetEjectCheckpoints() const;
   const std::vector<Point>& GetInductCheckpoints() const;
   const std::vector<Point> GetSpareLocations() const;
 
-  std::vector<Point> GetNeighbours(const Point& pos, const bool with_pos = true) const;
+  NeighboursRange GetNeighbours(const Point& pos, const bool with_pos = true) const;
   std::optional<Point> GetAnyNearSpareLocation(const Point& pos) const;
+  bool IsObstacle(const Point& pos) const;
+  size_t GetCellIndex(const Point& pos) const;
+  size_t GetCellsNumber() const;
+  int GetWidth() const;
+  int GetHeight() const;
+  // Shortest path distance ignoring other agents, falls back to Manhattan distance
+  // if there is no path at all
+  size_t GetDistance(const Point& from, const Point& to) const;
+  std::shared_ptr<const DistanceTable> GetDistanceTable(const Point& goal) const;
   size_t GetTimeToWaitNearCheckpoints() const;
   void ShuffleCheckpoints(const size_t seed = 42);
   void ApplyPermutation(
@@ -32,11 +99,26 @@ public:
   bool AllInductCheckpointsAreReachable() const;
 
 private:
-  void DFS(const Point& pos, std::set<Point>& used) const;
+  void DFS(const Point& pos, std::vector<bool>& used) const;
+  void ResetObstacles();
+  void SetObstacle(const Point& pos);
+  void BuildNeighboursTable();
 
-  int width;
-  int height;
-  std::set<Point> obstacles;
+  int width = 0;
+  int height = 0;
+  // Row-major occupancy grid, indexed by GetCellIndex
+  std::vector<uint8_t> obstacles;
+  size_t obstacles_cnt = 0;
+  // Compressed sparse row adjacency, rebuilt whenever obstacles change.
+  // Neighbours of cell i (including the cell itself, if it is free) are stored
+  // in neighbours[neighbours_offsets[i]..neighbours_offsets[i + 1]),
+  // neighbours_self[i] holds the position of the cell itself or kNoSelf.
+  static constexpr uint8_t kNoSelf = std::numeric_limits<uint8_t>::max();
+  std::vector<uint32_t> neighbours_offsets;
+  std::vector<Point> neighbours;
+  std::vector<uint8_t> neighbours_self;
+  // Shared between copies of the graph until obstacles change
+  std::shared_ptr<DistancesCache> distances_cache;
   std::vector<Point> eject_checkpoints;
   std::vector<Point> induct_checkpoints;
   size_t time_to_wait_near_checkpoints = 1;
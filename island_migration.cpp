@@ -0,0 +1,80 @@
+#include "island_migration.h"
+
+#include "common.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+IslandMigration::IslandMigration(
+    const std::string& dir_,
+    const size_t island_id_,
+    const size_t islands_cnt_,
+    const uint64_t config_hash_,
+    const size_t induct_checkpoints_cnt_)
+  : dir(dir_)
+  , island_id(island_id_)
+  , islands_cnt(islands_cnt_)
+  , config_hash(config_hash_)
+  , induct_checkpoints_cnt(induct_checkpoints_cnt_) {
+  ASSERT(island_id < islands_cnt && "Island id must be less than the number of islands");
+}
+
+std::string IslandMigration::GetFilename(const size_t id) const {
+  return dir + "/island_" + std::to_string(id);
+}
+
+// File format: config hash, epoch, score, checkpoints count, checkpoints
+void IslandMigration::Emigrate(const Migrant& migrant, const size_t epoch) const {
+  const std::string filename = GetFilename(island_id);
+  // Readers must never see a half written file
+  const std::string tmp_filename = filename + ".tmp";
+  std::ofstream outfile(tmp_filename);
+  outfile.precision(17);
+  outfile << config_hash << " " << epoch << " " << migrant.score << " "
+          << migrant.induct_checkpoints.size();
+  for (const size_t checkpoint : migrant.induct_checkpoints) {
+    outfile << " " << checkpoint;
+  }
+  outfile << "\n";
+  outfile.close();
+  if (outfile.fail()) {
+    LOG_WARNING << "Failed to write migrant to " << tmp_filename;
+    return;
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    LOG_WARNING << "Failed to publish migrant as " << filename;
+  }
+}
+
+std::optional<IslandMigration::Migrant> IslandMigration::Immigrate() {
+  std::ifstream infile(GetFilename((island_id + islands_cnt - 1) % islands_cnt));
+  uint64_t file_config_hash;
+  size_t epoch;
+  size_t checkpoints_cnt;
+  Migrant migrant;
+  if (!(infile >> file_config_hash >> epoch >> migrant.score >> checkpoints_cnt)
+      || file_config_hash != config_hash
+      || (last_immigration_epoch && last_immigration_epoch.value() >= epoch)
+      || checkpoints_cnt == 0 || checkpoints_cnt > induct_checkpoints_cnt) {
+    return std::nullopt;
+  }
+  migrant.induct_checkpoints.resize(checkpoints_cnt);
+  for (auto& checkpoint : migrant.induct_checkpoints) {
+    infile >> checkpoint;
+  }
+  if (!infile) {
+    return std::nullopt;
+  }
+  std::vector<size_t> sorted_checkpoints = migrant.induct_checkpoints;
+  std::sort(sorted_checkpoints.begin(), sorted_checkpoints.end());
+  if (sorted_checkpoints.back() >= induct_checkpoints_cnt
+      || std::adjacent_find(sorted_checkpoints.begin(), sorted_checkpoints.end())
+          != sorted_checkpoints.end()) {
+    LOG_WARNING << "Ignoring migrant with invalid checkpoints from epoch " << epoch;
+    return std::nullopt;
+  }
+  last_immigration_epoch = epoch;
+  return migrant;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// File based migration channel of the island model. Every island process publishes its
+// best layout to <dir>/island_<id> and takes migrants from the previous island of the
+// ring. Exchange is non-blocking: an island just takes the latest layout its neighbour
+// has published, if it hasn't seen it yet.
+class IslandMigration {
+public:
+  struct Migrant {
+    std::vector<size_t> induct_checkpoints;
+    double score;
+  };
+
+  IslandMigration(
+      const std::string& dir,
+      const size_t island_id,
+      const size_t islands_cnt,
+      const uint64_t config_hash,
+      const size_t induct_checkpoints_cnt);
+
+  // Failures are only logged, the island keeps evolving on its own
+  void Emigrate(const Migrant& migrant, const size_t epoch) const;
+  // Migrants published under another configuration or referring to checkpoints
+  // that don't exist are ignored
+  std::optional<Migrant> Immigrate();
+
+private:
+  std::string GetFilename(const size_t island_id) const;
+
+  std::string dir;
+  size_t island_id;
+  size_t islands_cnt;
+  uint64_t config_hash;
+  size_t induct_checkpoints_cnt;
+  std::optional<size_t> last_immigration_epoch;
+};
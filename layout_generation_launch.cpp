@@ -2,19 +2,29 @@
 #include "arguments_parser.h"
 // #include "CBS.h"
 #include "PBS.h"
+#include "fitness_cache.h"
 #include "genetic.h"
 #include "graph.h"
+#include "island_migration.h"
+#include "logging.h"
 
+#include "random.h"
+#include "snapshot.h"
 #include "task_assigner.h"
+#include "thread_pool.h"
 
 #include "yaml-cpp/yaml.h"
 
+#include <algorithm>
+#include <cmath>
+#include <ctime>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <numeric>
 #include <optional>
-#include <mutex>
+#include <sstream>
 #include <set>
-#include <thread>
 #include <unordered_map>
 
 struct BestAssignment {
@@ -27,9 +37,43 @@ struct BestAssignment {
 
 namespace {
 
-void LogBestAssignment(const std::optional<BestAssignment>& assignment_opt, const size_t epoch) {
+constexpr uint64_t kSnapshotMagic = 0x50414e534f59414cULL;  // "LAYOSNAP"
+constexpr uint32_t kSnapshotVersion = 4;
+
+constexpr size_t kWindowSize = 30;
+// AStar horizon has to cover the window and a few steps past it, otherwise the executed
+// prefixes of the paths are never checked against the constraints
+constexpr size_t kMinAStarHorizonMargin = 5;
+
+double GetThreadCPUTime() {
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void LogParetoFront(
+    const std::vector<Chromosome>& front, const size_t epoch, const std::string& prefix) {
+  std::ofstream outfile("data/pareto_front_" + prefix + "epoch_" + std::to_string(epoch));
+  outfile << "throughput kept_ratio cpu_time : induct checkpoints" << std::endl;
+  for (const auto& chromosome : front) {
+    const auto& objectives = chromosome.GetObjectives().value();
+    outfile << objectives.throughput << " " << objectives.kept_ratio << " "
+            << objectives.cpu_time << " :";
+    auto checkpoints = chromosome.GetCheckpointsPermutation();
+    std::sort(checkpoints.begin(), checkpoints.end());
+    for (const size_t checkpoint : checkpoints) {
+      outfile << " " << checkpoint;
+    }
+    outfile << std::endl;
+  }
+}
+
+void LogBestAssignment(
+    const std::optional<BestAssignment>& assignment_opt,
+    const size_t epoch,
+    const std::string& prefix) {
   std::ofstream outfile;
-  const std::string filename = "data/best_assignment_epoch_" + std::to_string(epoch);
+  const std::string filename = "data/best_assignment_" + prefix + "epoch_" + std::to_string(epoch);
   outfile.open(filename);
   if (assignment_opt) {
     const auto& assignment = assignment_opt.value();
@@ -46,126 +90,595 @@ void LogBestAssignment(const std::optional<BestAssignment>& assignment_opt, cons
   outfile.close();
 }
 
+// Pooled standard deviation of the chain throughputs around the mean of their chromosome
+class ChainsSpread {
+public:
+  void Add(const std::vector<double>& throughputs) {
+    if (throughputs.size() < 2) {
+      return;
+    }
+    const double mean =
+        std::accumulate(throughputs.begin(), throughputs.end(), 0.0) / throughputs.size();
+    for (const double throughput : throughputs) {
+      squared_deviations_sum += (throughput - mean) * (throughput - mean);
+    }
+    degrees_of_freedom += throughputs.size() - 1;
+  }
+
+  std::optional<double> StdDev() const {
+    if (degrees_of_freedom == 0) {
+      return std::nullopt;
+    }
+    return std::sqrt(squared_deviations_sum / degrees_of_freedom);
+  }
+
+  void Save(SnapshotWriter& writer) const {
+    writer.Write(squared_deviations_sum);
+    writer.Write(degrees_of_freedom);
+  }
+  void Load(SnapshotReader& reader) {
+    reader.Read(squared_deviations_sum);
+    reader.Read(degrees_of_freedom);
+  }
+
+private:
+  double squared_deviations_sum = 0.0;
+  size_t degrees_of_freedom = 0;
+};
+
 struct TaskAssigners {
   TaskAssigners() = delete;
   TaskAssigners(
       const size_t assigners_cnt,
       const size_t induct_cnt,
       const size_t eject_cnt,
-      const size_t assignments_cnt) {
+      const size_t assignments_cnt,
+      const uint64_t seed) {
     assigners.reserve(assigners_cnt);
     for (size_t i = 0; i < assigners_cnt; ++i) {
-      assigners.push_back(TaskAssigner(induct_cnt, eject_cnt, assignments_cnt, i + 1));
+      assigners.push_back(MakeAssigner(induct_cnt, eject_cnt, assignments_cnt, seed, i));
     }
   }
 
+  // The assigner of chain `idx`, chains of layouts with another number of induct
+  // checkpoints are built the same way
+  static TaskAssigner MakeAssigner(
+      const size_t induct_cnt,
+      const size_t eject_cnt,
+      const size_t assignments_cnt,
+      const uint64_t seed,
+      const size_t idx) {
+    return TaskAssigner(induct_cnt, eject_cnt, assignments_cnt, DeriveSeed(seed, idx + 1));
+  }
+
   std::vector<TaskAssigner> assigners;
 };
 
 }
 
 void GenerateLayout(int argc, char** argv) {
-  // Mute all cerr
-  freopen("log.cerr", "w", stderr);
-
   const auto params = ParseArguments(argc, argv);
 
-  Graph graph_full(params["file"].as<std::string>(), 1.0);
+  // Island model: every process evolves its own population on the same problem
+  const size_t islands_cnt = std::max<size_t>(1, params["islands"].as<size_t>());
+  const size_t island_id = params["island_id"].as<size_t>();
+  const std::string output_prefix =
+      islands_cnt > 1 ? "island_" + std::to_string(island_id) + "_" : "";
+  // Files rewritten after every epoch can't be shared, the islands would replace each
+  // other's versions
+  const auto island_filename = [&](const std::string& filename) {
+    if (islands_cnt == 1 || filename.empty()) {
+      return filename;
+    }
+    return filename + ".island_" + std::to_string(island_id);
+  };
+
+  // Mute all cerr
+  const std::string cerr_filename =
+      islands_cnt > 1 ? "log.island_" + std::to_string(island_id) + ".cerr" : "log.cerr";
+  freopen(cerr_filename.c_str(), "w", stderr);
+  SetLogLevel(ParseLogLevel(params["log_level"].as<std::string>()));
+
+  const size_t seed = params["seed"].as<size_t>();
+  Graph graph_full(params["file"].as<std::string>(), 1.0, seed);
   const size_t assignments_cnt = params["assignments"].as<size_t>();
   const double kept_checkpoint_ratio = params["checkpoints_ratio"].as<double>();
+  const size_t kept_induct_cnt = graph_full.GetInductCheckpoints().size() * kept_checkpoint_ratio;
   TaskAssigners task_assigners_init(
       params["chains"].as<size_t>(),
-      graph_full.GetInductCheckpoints().size() * kept_checkpoint_ratio,
+      kept_induct_cnt,
       graph_full.GetEjectCheckpoints().size(),
-      assignments_cnt);
-  const Agents agents_init(graph_full, params["agents"].as<size_t>());
-  const size_t generation_size = 3;
+      assignments_cnt,
+      seed);
+  const Agents agents_init(graph_full, params["agents"].as<size_t>(), seed);
+  PBSParams pbs_params;
+  pbs_params.low_level_planner = ParseLowLevelPlanner(params["planner"].as<std::string>());
+  pbs_params.conflict_selection =
+      ParseConflictSelection(params["conflict_selection"].as<std::string>());
+  pbs_params.search_mode = ParsePBSSearchMode(params["pbs_search"].as<std::string>());
+  pbs_params.threads = std::max<size_t>(1, params["pbs_threads"].as<size_t>());
+  pbs_params.deterministic = params["pbs_deterministic"].as<bool>();
+  pbs_params.warm_start = params["pbs_warm_start"].as<bool>();
+  pbs_params.independent_root = params["pbs_independent_root"].as<bool>();
+  if (params["astar_horizon"].as<size_t>() > 0) {
+    if (params["astar_horizon"].as<size_t>() < kWindowSize + kMinAStarHorizonMargin) {
+      std::cout << "--astar_horizon has to be 0 or at least "
+                << kWindowSize + kMinAStarHorizonMargin << std::endl;
+      exit(0);
+    }
+    if (pbs_params.low_level_planner != LowLevelPlanner::AStar) {
+      // SIPP always plans full paths
+      std::cout << "--astar_horizon can be used only with --planner astar" << std::endl;
+      exit(0);
+    }
+    pbs_params.low_level_horizon = params["astar_horizon"].as<size_t>();
+  }
+  GenerationParams generation_params;
+  generation_params.size = std::max<size_t>(1, params["population"].as<size_t>());
+  generation_params.elite_cnt = params["elites"].as<size_t>();
+  generation_params.selection = ParseSelectionScheme(params["selection"].as<std::string>());
+  generation_params.tournament_size = std::max<size_t>(1, params["tournament_size"].as<size_t>());
+  generation_params.pairing = ParsePairingStrategy(params["pairing"].as<std::string>());
+  generation_params.multi_objective = params["multi_objective"].as<bool>();
+  generation_params.max_kept_checkpoints = assignments_cnt;
+  const size_t generation_size = generation_params.size;
   Generation generation(
-      generation_size,
+      generation_params,
       graph_full.GetInductCheckpoints().size(),
       kept_checkpoint_ratio,
-      params["entropy"].as<double>());
+      params["entropy"].as<double>(),
+      island_id == 0 ? seed : DeriveSeed(seed, island_id));
 
   double total_throughput = 0.0;
   double min_throughput = std::numeric_limits<double>::max();
   std::optional<BestAssignment> best_assignment;
 
-  std::mutex mtx;
-  const auto& run_pbs = [&](Chromosome& chromosome) {
-    Graph graph = graph_full;
-    graph.KeepOnlySelectedCheckpoints(chromosome.GetCheckpointsPermutation());
-    TaskAssigners task_assigners = task_assigners_init;
-    Agents agents = agents_init;
+  ThreadPool thread_pool(params["threads"].as<size_t>());
+
+  // Everything besides the kept checkpoints that changes the score of a layout
+  std::ostringstream fitness_config;
+  fitness_config << params["file"].as<std::string>()
+                 << " seed " << seed
+                 << " agents " << params["agents"].as<size_t>()
+                 << " assignments " << assignments_cnt
+                 << " chains " << task_assigners_init.assigners.size()
+                 << " window " << kWindowSize
+                 << " planner " << params["planner"].as<std::string>()
+                 << " conflict_selection " << params["conflict_selection"].as<std::string>()
+                 << " pbs_search " << params["pbs_search"].as<std::string>()
+                 << " pbs_warm_start " << pbs_params.warm_start
+                 << " pbs_threads " << pbs_params.threads
+                 << " pbs_deterministic " << pbs_params.deterministic
+                 << " pbs_independent_root " << pbs_params.independent_root
+                 << " astar_horizon " << params["astar_horizon"].as<size_t>();
+  if (params["racing"].as<bool>()) {
+    // Racing scores the layouts that survive it on extra chains
+    fitness_config << " racing_confidence " << params["racing_confidence"].as<double>();
+  }
+  const uint64_t fitness_config_hash = HashFitnessConfig(fitness_config.str());
+  FitnessCache fitness_cache(fitness_config_hash);
+  const std::string fitness_cache_file =
+      island_filename(params["fitness_cache"].as<std::string>());
+  if (!fitness_cache_file.empty()) {
+    fitness_cache.Load(fitness_cache_file);
+  }
+
+  std::optional<IslandMigration> island_migration;
+  const size_t migration_interval = std::max<size_t>(1, params["migration_interval"].as<size_t>());
+  if (islands_cnt > 1) {
+    island_migration.emplace(
+        params["migration_dir"].as<std::string>(),
+        island_id,
+        islands_cnt,
+        fitness_config_hash,
+        graph_full.GetInductCheckpoints().size());
+  }
+
+  // Racing: chains are run one round at a time and a chromosome is dropped once
+  // the upper confidence bound of its mean throughput is below the best throughput
+  const bool racing = params["racing"].as<bool>();
+  if (generation_params.multi_objective && (racing || islands_cnt > 1)) {
+    // Both compare layouts by the throughput alone
+    std::cout << "--multi_objective can't be combined with --racing or --islands" << std::endl;
+    exit(0);
+  }
+  if (generation_params.multi_objective && pbs_params.threads > 1) {
+    // Only the thread calling PBS is measured, the CPU time objective would miss its workers
+    std::cout << "--multi_objective can't be combined with --pbs_threads above 1" << std::endl;
+    exit(0);
+  }
+  const double racing_confidence = params["racing_confidence"].as<double>();
+  ChainsSpread chains_spread;
+
+  // Results of one chromosome, every assigner chain fills its own slot
+  struct ChromosomeEvaluation {
+    std::vector<size_t> induct_checkpoints;
+    // Earlier chromosome of the same generation with the same checkpoints, it's evaluated
+    // once and its result is copied
+    std::optional<size_t> original;
+    std::optional<FitnessCache::Entry> cached;
+    // Score of the chromosome once the generation is reduced
+    std::optional<FitnessCache::Entry> result;
+    Graph graph;
+    bool is_valid = false;
+    bool is_dropped = false;
+    size_t chains_submitted = 0;
+    std::vector<double> throughputs;
+    std::vector<double> cpu_times;
+    std::vector<std::vector<Point>> first_assigner_paths;
+    Agents last_assigner_agents;
+  };
+
+  const size_t chains_cnt = task_assigners_init.assigners.size();
+  // Chains are independent jobs, when submitted from a worker idle workers steal them.
+  // Chains past chains_cnt are the extra ones of racing, the slots of the evaluation
+  // have to be resized for them before they are submitted.
+  const auto& submit_chains = [&](
+      ChromosomeEvaluation& evaluation, const size_t chains_to_submit) {
+    const size_t first_chain = evaluation.chains_submitted;
+    evaluation.chains_submitted =
+        std::min(evaluation.throughputs.size(), first_chain + chains_to_submit);
+    for (size_t chain = first_chain; chain < evaluation.chains_submitted; ++chain) {
+      thread_pool.Submit([&, chain] {
+        const size_t induct_cnt = evaluation.induct_checkpoints.size();
+        const bool is_extra_chain = chain >= chains_cnt;
+        // Streams up to chains_cnt belong to the task assigners, the next chains_cnt ones
+        // to PBS. Extra chains take two streams each after them.
+        TaskAssigner task_assigner = induct_cnt == kept_induct_cnt && !is_extra_chain
+            ? task_assigners_init.assigners[chain]
+            : TaskAssigners::MakeAssigner(
+                induct_cnt,
+                graph_full.GetEjectCheckpoints().size(),
+                assignments_cnt,
+                seed,
+                is_extra_chain ? 2 * chain : chain);
+        PBSParams chain_pbs_params = pbs_params;
+        chain_pbs_params.seed =
+            DeriveSeed(seed, is_extra_chain ? 2 * chain + 2 : chains_cnt + chain + 1);
+        Agents agents = agents_init;
+        // Only the calling thread is measured, workers of a parallel PBS are not
+        const double cpu_time_start = GetThreadCPUTime();
+        auto paths = PriorityBasedSearch(
+            agents, evaluation.graph, task_assigner, kWindowSize, chain_pbs_params);
+        evaluation.cpu_times[chain] = GetThreadCPUTime() - cpu_time_start;
+        evaluation.throughputs[chain] = CalculateThroughput(paths, assignments_cnt);
+        if (chain == 0) {
+          evaluation.first_assigner_paths = std::move(paths);
+        }
+        if (chain + 1 == chains_cnt) {
+          evaluation.last_assigner_agents = std::move(agents);
+        }
+      });
+    }
+  };
+
+  const auto& run_pbs = [&](ChromosomeEvaluation& evaluation) {
+    // A cached score above the best one comes from an earlier run, it has to be
+    // recomputed to get the paths of the new best assignment. The multi-objective
+    // selection also needs the CPU time, which some entries don't have.
+    const auto cached = fitness_cache.Find(evaluation.induct_checkpoints);
+    if (cached && (!cached->score
+        || ((cached->cpu_time || !generation_params.multi_objective)
+            && best_assignment && cached->score.value() <= best_assignment->throughput))) {
+      evaluation.cached = cached;
+      return;
+    }
+    evaluation.graph = graph_full;
+    evaluation.graph.KeepOnlySelectedCheckpoints(evaluation.induct_checkpoints);
     // Explicitly check that
     // - graph is connected
     // - it's possible to reach all the eject checkpoints
-    if (!graph.IsConnected() || !graph.AllInductCheckpointsAreReachable()) {
-      chromosome.Invalidate();
+    if (!evaluation.graph.IsConnected()
+        || !evaluation.graph.AllInductCheckpointsAreReachable()) {
       return;
     }
-    double throughput_avg = 0;
+    evaluation.is_valid = true;
+    evaluation.throughputs.resize(chains_cnt);
+    evaluation.cpu_times.resize(chains_cnt);
+    submit_chains(evaluation, racing ? 1 : chains_cnt);
+  };
 
-    std::vector<std::vector<Point>> first_assigner_paths;
-    for (size_t i = 0; i < task_assigners.assigners.size(); ++i) {
-      auto& task_assigner = task_assigners.assigners[i];
-      agents = agents_init;
-      auto paths = PriorityBasedSearch(agents, graph, task_assigner, 30);
-      if (i == 0) {
-        first_assigner_paths = paths;
-      }
-      const double throughput = CalculateThroughput(paths, assignments_cnt);
-      throughput_avg += throughput;
+  size_t dropped_cnt = 0;
+  size_t first_epoch = 0;
+
+  // The snapshot holds everything the next epoch depends on, so a resumed run continues
+  // exactly as the interrupted one would have
+  const std::string snapshot_file = island_filename(params["snapshot"].as<std::string>());
+  std::ostringstream snapshot_config;
+  snapshot_config << fitness_config.str()
+                  << " checkpoints_ratio " << kept_checkpoint_ratio
+                  << " entropy " << params["entropy"].as<double>()
+                  << " population " << generation_size
+                  << " elites " << params["elites"].as<size_t>()
+                  << " selection " << params["selection"].as<std::string>()
+                  << " tournament_size " << params["tournament_size"].as<size_t>()
+                  << " pairing " << params["pairing"].as<std::string>()
+                  << " multi_objective " << generation_params.multi_objective
+                  << " racing " << racing
+                  << " racing_confidence " << racing_confidence
+                  << " island_id " << island_id;
+  const uint64_t config_hash = HashFitnessConfig(snapshot_config.str());
+  const auto& save_snapshot = [&](const size_t next_epoch) {
+    SnapshotWriter writer(snapshot_file);
+    writer.Write(kSnapshotMagic);
+    writer.Write(kSnapshotVersion);
+    writer.Write(config_hash);
+    writer.Write(next_epoch);
+    generation.Save(writer);
+    writer.Write(best_assignment.has_value());
+    if (best_assignment) {
+      writer.Write(best_assignment->paths);
+      writer.Write(best_assignment->throughput);
+      writer.Write(best_assignment->induct_checkpoints_indices);
+      best_assignment->agents.Save(writer);
     }
-    throughput_avg /= task_assigners.assigners.size();
-    chromosome.SetScore(throughput_avg);
-    {
-      std::lock_guard<std::mutex> lock(mtx);
-      if (!best_assignment || best_assignment->throughput < throughput_avg) {
-        if (!best_assignment) {
-          best_assignment = BestAssignment();
-        }
-        best_assignment->paths = std::move(first_assigner_paths);
-        best_assignment->throughput = throughput_avg;
-        best_assignment->induct_checkpoints_indices = chromosome.GetCheckpointsPermutation();
-        best_assignment->graph = graph;
-        best_assignment->agents = agents;
-      }
-      min_throughput = std::min(min_throughput, throughput_avg);
-      total_throughput += throughput_avg;
+    writer.Write(total_throughput);
+    writer.Write(min_throughput);
+    writer.Write(dropped_cnt);
+    chains_spread.Save(writer);
+    fitness_cache.Save(writer);
+    if (!writer.Commit()) {
+      LOG_ERROR << "Failed to write snapshot " << snapshot_file;
+    }
+  };
+  const auto& load_snapshot = [&]() {
+    SnapshotReader reader(snapshot_file);
+    uint64_t magic = 0;
+    uint32_t version = 0;
+    uint64_t snapshot_config_hash = 0;
+    reader.Read(magic);
+    reader.Read(version);
+    reader.Read(snapshot_config_hash);
+    if (!reader.Good() || magic != kSnapshotMagic || version != kSnapshotVersion) {
+      std::cout << "Can't resume from " << snapshot_file << " : not a snapshot" << std::endl;
+      exit(0);
+    }
+    if (snapshot_config_hash != config_hash) {
+      std::cout << "Can't resume from " << snapshot_file
+                << " : it was made with different arguments" << std::endl;
+      exit(0);
+    }
+    reader.Read(first_epoch);
+    generation.Load(reader);
+    bool has_best_assignment = false;
+    reader.Read(has_best_assignment);
+    if (has_best_assignment) {
+      best_assignment = BestAssignment();
+      reader.Read(best_assignment->paths);
+      reader.Read(best_assignment->throughput);
+      reader.Read(best_assignment->induct_checkpoints_indices);
+      best_assignment->agents.Load(reader);
+      best_assignment->graph = graph_full;
+      best_assignment->graph.KeepOnlySelectedCheckpoints(
+          best_assignment->induct_checkpoints_indices);
+    }
+    reader.Read(total_throughput);
+    reader.Read(min_throughput);
+    reader.Read(dropped_cnt);
+    chains_spread.Load(reader);
+    fitness_cache.Load(reader);
+    if (!reader.Good()) {
+      std::cout << "Can't resume from " << snapshot_file << " : file is truncated" << std::endl;
+      exit(0);
+    }
+  };
+  if (params["resume"].as<bool>()) {
+    if (snapshot_file.empty()) {
+      std::cout << "--resume needs a --snapshot file" << std::endl;
+      exit(0);
+    }
+    load_snapshot();
+    std::cout << "Resuming from epoch " << first_epoch + 1 << std::endl;
+  }
+
+  const size_t induct_checkpoints_cnt = graph_full.GetInductCheckpoints().size();
+  const auto& set_fitness = [&](
+      Chromosome& chromosome, const double throughput, const double cpu_time) {
+    if (generation_params.multi_objective) {
+      const double kept_ratio =
+          chromosome.GetCheckpointsPermutation().size() / static_cast<double>(induct_checkpoints_cnt);
+      chromosome.SetObjectives({throughput, kept_ratio, cpu_time});
+    } else {
+      chromosome.SetScore(throughput);
     }
   };
 
   const size_t steps = params["epochs"].as<size_t>();
-  for (size_t i = 0; i < steps; ++i) {
+  for (size_t i = first_epoch; i < steps; ++i) {
     std::cout << "Generation " << i + 1 << std::endl;
     std::cout.flush();
-    auto chromosomes = generation.GetChromosomesMutable();
-    std::vector<std::thread> threads;
-    threads.reserve(generation.GetChromosomesMutable().size());
-    for (auto& chromosome : generation.GetChromosomesMutable()) {
-      threads.push_back(std::thread(run_pbs, std::ref(chromosome)));
+    auto& chromosomes = generation.GetChromosomesMutable();
+    std::vector<ChromosomeEvaluation> evaluations(chromosomes.size());
+    std::map<std::vector<size_t>, size_t> first_evaluations;
+    for (size_t j = 0; j < chromosomes.size(); ++j) {
+      // The score depends only on the set of kept checkpoints, not on their order
+      auto& evaluation = evaluations[j];
+      evaluation.induct_checkpoints = chromosomes[j].GetCheckpointsPermutation();
+      std::sort(evaluation.induct_checkpoints.begin(), evaluation.induct_checkpoints.end());
+      const auto [it, inserted] = first_evaluations.emplace(evaluation.induct_checkpoints, j);
+      if (!inserted) {
+        evaluation.original = it->second;
+        continue;
+      }
+      thread_pool.Submit([&, j] { run_pbs(evaluations[j]); });
     }
-    for (auto& thread : threads) {
-      thread.join();
+    thread_pool.Wait();
+
+    for (size_t round = 1; racing && round < chains_cnt; ++round) {
+      const auto std_dev_opt = chains_spread.StdDev();
+      for (auto& evaluation : evaluations) {
+        if (!evaluation.is_valid || evaluation.is_dropped
+            || evaluation.chains_submitted == chains_cnt) {
+          continue;
+        }
+        if (best_assignment && std_dev_opt) {
+          const size_t chains_done = evaluation.chains_submitted;
+          const double mean = std::accumulate(
+              evaluation.throughputs.begin(),
+              evaluation.throughputs.begin() + chains_done,
+              0.0) / chains_done;
+          const double upper_bound =
+              mean + racing_confidence * std_dev_opt.value() / std::sqrt(chains_done);
+          if (upper_bound < best_assignment->throughput) {
+            evaluation.is_dropped = true;
+            continue;
+          }
+        }
+        submit_chains(evaluation, 1);
+      }
+      thread_pool.Wait();
+    }
+
+    if (racing) {
+      // Chains saved on the dropped chromosomes are spent on extra chains of the ones that
+      // survived, one at a time in the order of their mean throughput, so that the best
+      // layouts are told apart on more assignments. No chromosome gets more than twice
+      // the regular chains.
+      size_t saved_chains = 0;
+      std::vector<std::pair<double, size_t>> survivors;
+      for (size_t j = 0; j < evaluations.size(); ++j) {
+        const auto& evaluation = evaluations[j];
+        if (evaluation.is_dropped) {
+          saved_chains += chains_cnt - evaluation.chains_submitted;
+        } else if (evaluation.is_valid) {
+          const double mean = std::accumulate(
+              evaluation.throughputs.begin(), evaluation.throughputs.end(), 0.0) / chains_cnt;
+          survivors.emplace_back(-mean, j);
+        }
+      }
+      std::sort(survivors.begin(), survivors.end());
+      std::vector<size_t> extra_chains(survivors.size(), 0);
+      for (size_t round = 0; round < chains_cnt && saved_chains > 0; ++round) {
+        for (size_t k = 0; k < survivors.size() && saved_chains > 0; ++k) {
+          ++extra_chains[k];
+          --saved_chains;
+        }
+      }
+      for (size_t k = 0; k < survivors.size() && extra_chains[k] > 0; ++k) {
+        auto& evaluation = evaluations[survivors[k].second];
+        evaluation.throughputs.resize(chains_cnt + extra_chains[k]);
+        evaluation.cpu_times.resize(chains_cnt + extra_chains[k]);
+        submit_chains(evaluation, extra_chains[k]);
+      }
+      thread_pool.Wait();
+    }
+
+    for (size_t j = 0; j < chromosomes.size(); ++j) {
+      auto& evaluation = evaluations[j];
+      if (evaluation.original) {
+        const auto& original = evaluations[evaluation.original.value()];
+        evaluation.cached = original.result;
+        evaluation.is_dropped = original.is_dropped;
+      }
+      if (evaluation.cached) {
+        evaluation.result = evaluation.cached;
+        if (!evaluation.cached->score) {
+          chromosomes[j].Invalidate();
+          continue;
+        }
+        const double throughput_avg = evaluation.cached->score.value();
+        set_fitness(chromosomes[j], throughput_avg, evaluation.cached->cpu_time.value_or(0.0));
+        if (evaluation.is_dropped) {
+          ++dropped_cnt;
+          continue;
+        }
+        min_throughput = std::min(min_throughput, throughput_avg);
+        total_throughput += throughput_avg;
+        continue;
+      }
+      if (!evaluation.is_valid) {
+        evaluation.result = FitnessCache::Entry();
+        fitness_cache.Insert(evaluation.induct_checkpoints, FitnessCache::Entry());
+        chromosomes[j].Invalidate();
+        continue;
+      }
+      evaluation.throughputs.resize(evaluation.chains_submitted);
+      evaluation.cpu_times.resize(evaluation.chains_submitted);
+      double throughput_avg = 0;
+      for (const double throughput : evaluation.throughputs) {
+        throughput_avg += throughput;
+      }
+      throughput_avg /= evaluation.throughputs.size();
+      const double cpu_time_avg =
+          std::accumulate(evaluation.cpu_times.begin(), evaluation.cpu_times.end(), 0.0)
+          / evaluation.cpu_times.size();
+      evaluation.result = FitnessCache::Entry{throughput_avg, cpu_time_avg};
+      set_fitness(chromosomes[j], throughput_avg, cpu_time_avg);
+      // A dropped chromosome keeps its partial score for the selection, but it's
+      // neither cached, nor a candidate for the best assignment, nor counted in the
+      // throughput statistics
+      if (evaluation.is_dropped) {
+        ++dropped_cnt;
+        continue;
+      }
+      min_throughput = std::min(min_throughput, throughput_avg);
+      total_throughput += throughput_avg;
+      chains_spread.Add(evaluation.throughputs);
+      fitness_cache.Insert(
+          evaluation.induct_checkpoints, FitnessCache::Entry{throughput_avg, cpu_time_avg});
+      if (!best_assignment || best_assignment->throughput < throughput_avg) {
+        if (!best_assignment) {
+          best_assignment = BestAssignment();
+        }
+        best_assignment->paths = std::move(evaluation.first_assigner_paths);
+        best_assignment->throughput = throughput_avg;
+        best_assignment->induct_checkpoints_indices = std::move(evaluation.induct_checkpoints);
+        best_assignment->graph = std::move(evaluation.graph);
+        best_assignment->agents = std::move(evaluation.last_assigner_agents);
+      }
     }
     std::cout << "Done " << i + 1 << std::endl;
     std::cout.flush();
 
+    if (island_migration && (i + 1) % migration_interval == 0) {
+      if (best_assignment) {
+        island_migration->Emigrate(
+            {best_assignment->induct_checkpoints_indices, best_assignment->throughput}, i);
+      }
+      auto migrant_opt = island_migration->Immigrate();
+      if (migrant_opt) {
+        std::sort(
+            migrant_opt->induct_checkpoints.begin(), migrant_opt->induct_checkpoints.end());
+        // Migrants come without the CPU time they were planned in
+        fitness_cache.Insert(
+            migrant_opt->induct_checkpoints,
+            FitnessCache::Entry{migrant_opt->score, std::nullopt});
+        generation.AcceptMigrant(migrant_opt->induct_checkpoints, migrant_opt->score);
+      }
+    }
+
     if (i % 10 == 0) {
-      LogBestAssignment(best_assignment, i);
+      LogBestAssignment(best_assignment, i, output_prefix);
+    }
+    if (!fitness_cache_file.empty()) {
+      fitness_cache.Save(fitness_cache_file);
     }
     generation.Evolve();
+    if (generation_params.multi_objective && i % 10 == 0) {
+      LogParetoFront(generation.GetParetoFront(), i, output_prefix);
+    }
+    if (!snapshot_file.empty()) {
+      save_snapshot(i + 1);
+    }
   }
 
   if (!best_assignment) {
     std::cout << "No solution found" << std::endl;
     return;
   }
-  LogBestAssignment(best_assignment, steps);
+  LogBestAssignment(best_assignment, steps, output_prefix);
   std::cout << "Worst throughput : " << min_throughput << std::endl;
   std::cout << "Best throughput : " << best_assignment->throughput << std::endl;
   std::cout << "Average throughput : "
-            << total_throughput / (steps * generation_size) << std::endl;
+            << total_throughput / (steps * generation_size - dropped_cnt) << std::endl;
+  if (racing) {
+    std::cout << "Dropped by racing : " << dropped_cnt << std::endl;
+  }
+  if (generation_params.multi_objective) {
+    const auto pareto_front = generation.GetParetoFront();
+    LogParetoFront(pareto_front, steps, output_prefix);
+    std::cout << "Pareto front size : " << pareto_front.size() << std::endl;
+  }
 
   return;
 }
@@ -0,0 +1,81 @@
+#include "logging.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+constexpr size_t kFlushThreshold = 64 * 1024;
+
+std::atomic<int> runtime_level = static_cast<int>(LogLevel::Info);
+std::mutex sink_mtx;
+
+struct ThreadBuffer {
+  std::ostringstream stream;
+
+  ~ThreadBuffer() {
+    Flush();
+  }
+
+  void Flush() {
+    const std::string data = stream.str();
+    if (data.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(sink_mtx);
+      std::fwrite(data.data(), 1, data.size(), stderr);
+      std::fflush(stderr);
+    }
+    stream.str({});
+  }
+};
+
+ThreadBuffer& GetThreadBuffer() {
+  thread_local ThreadBuffer buffer;
+  return buffer;
+}
+
+}
+
+LogLevel ParseLogLevel(const std::string& name) {
+  if (name == "none") {
+    return LogLevel::None;
+  } else if (name == "error") {
+    return LogLevel::Error;
+  } else if (name == "warning") {
+    return LogLevel::Warning;
+  } else if (name == "info") {
+    return LogLevel::Info;
+  } else if (name == "debug") {
+    return LogLevel::Debug;
+  }
+  std::cout << "Unknown log level : " << name << std::endl;
+  exit(1);
+}
+
+void SetLogLevel(const LogLevel level) {
+  runtime_level = static_cast<int>(level);
+}
+
+bool IsLogEnabled(const LogLevel level) {
+  return static_cast<int>(level) <= runtime_level.load(std::memory_order_relaxed);
+}
+
+void FlushLog() {
+  GetThreadBuffer().Flush();
+}
+
+LogLine::LogLine()
+  : stream(GetThreadBuffer().stream) {}
+
+LogLine::~LogLine() {
+  stream << '\n';
+  auto& buffer = GetThreadBuffer();
+  if (static_cast<size_t>(buffer.stream.tellp()) >= kFlushThreshold) {
+    buffer.Flush();
+  }
+}
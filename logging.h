@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+// Levelled logging for hot paths. Messages above the compile-time LOG_LEVEL (see
+// CMakeLists.txt) are removed from the build, the rest are filtered at runtime by
+// SetLogLevel(). Every thread appends its lines to its own buffer, which is written to
+// stderr in one piece, so output of concurrent searches does not interleave.
+//
+//   LOG_WARNING << "AStar is stuck on " << agent.id << "!";
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+enum class LogLevel {
+  None = LOG_LEVEL_NONE,
+  Error = LOG_LEVEL_ERROR,
+  Warning = LOG_LEVEL_WARNING,
+  Info = LOG_LEVEL_INFO,
+  Debug = LOG_LEVEL_DEBUG
+};
+
+LogLevel ParseLogLevel(const std::string& name);
+
+void SetLogLevel(const LogLevel level);
+bool IsLogEnabled(const LogLevel level);
+
+// Writes the calling thread's buffer to stderr. Buffers are also flushed when they grow
+// large and when their thread exits.
+void FlushLog();
+
+// One line of the log, it is appended to the thread's buffer on destruction
+class LogLine {
+public:
+  LogLine();
+  ~LogLine();
+
+  template <typename T>
+  LogLine& operator << (const T& value) {
+    stream << value;
+    return *this;
+  }
+
+private:
+  std::ostream& stream;
+};
+
+// Streams elements of a container separated by spaces
+template <typename Container>
+struct LogRange {
+  const Container& values;
+};
+
+template <typename Container>
+std::ostream& operator << (std::ostream& ostream, const LogRange<Container>& range) {
+  for (const auto& value : range.values) {
+    ostream << value << " ";
+  }
+  return ostream;
+}
+
+template <typename Container>
+LogRange<Container> MakeLogRange(const Container& values) {
+  return {values};
+}
+
+#define LOG_IF_ENABLED(level) \
+  if (!IsLogEnabled(level)) {} else LogLine()
+#define LOG_DISABLED \
+  if (true) {} else LogLine()
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR LOG_IF_ENABLED(LogLevel::Error)
+#else
+#define LOG_ERROR LOG_DISABLED
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING LOG_IF_ENABLED(LogLevel::Warning)
+#else
+#define LOG_WARNING LOG_DISABLED
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO LOG_IF_ENABLED(LogLevel::Info)
+#else
+#define LOG_INFO LOG_DISABLED
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG LOG_IF_ENABLED(LogLevel::Debug)
+#else
+#define LOG_DEBUG LOG_DISABLED
+#endif
@@ -0,0 +1,77 @@
+#include "random.h"
+
+#include "common.h"
+
+namespace {
+
+uint64_t SplitMix64(uint64_t& x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  uint64_t z = x;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+uint64_t RotateLeft(const uint64_t x, const int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+}
+
+uint64_t DeriveSeed(const uint64_t seed, const uint64_t stream) {
+  uint64_t x = seed;
+  const uint64_t seed_hash = SplitMix64(x);
+  x = seed_hash ^ stream;
+  return SplitMix64(x);
+}
+
+Random::Random(const uint64_t seed) {
+  uint64_t x = seed;
+  for (auto& word : state) {
+    word = SplitMix64(x);
+  }
+}
+
+Random::result_type Random::operator()() {
+  const uint64_t result = RotateLeft(state[1] * 5, 7) * 9;
+  const uint64_t t = state[1] << 17;
+  state[2] ^= state[0];
+  state[3] ^= state[1];
+  state[1] ^= state[2];
+  state[0] ^= state[3];
+  state[2] ^= t;
+  state[3] = RotateLeft(state[3], 45);
+  return result;
+}
+
+size_t Random::UniformIndex(const size_t bound) {
+  ASSERT(bound > 0 && "Empty range to choose from");
+  // Rejection of the incomplete last block removes the modulo bias
+  const uint64_t limit = max() - max() % bound;
+  uint64_t value;
+  do {
+    value = (*this)();
+  } while (value >= limit);
+  return value % bound;
+}
+
+double Random::UniformReal() {
+  // 53 high bits fill the mantissa of a double
+  return ((*this)() >> 11) * (1.0 / (1ULL << 53));
+}
+
+bool Random::Bernoulli(const double probability) {
+  return UniformReal() < probability;
+}
+
+void Random::Save(SnapshotWriter& writer) const {
+  for (const auto word : state) {
+    writer.Write(word);
+  }
+}
+
+void Random::Load(SnapshotReader& reader) {
+  for (auto& word : state) {
+    reader.Read(word);
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "snapshot.h"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+// Seed of the independent stream `stream` of the generator seeded with `seed`.
+// It's a pure function of its arguments, so parallel jobs can get their own
+// generators without depending on the order they are scheduled in.
+uint64_t DeriveSeed(const uint64_t seed, const uint64_t stream);
+
+// Seedable xoshiro256** generator. Unlike rand() it has no global state, so every
+// owner gets a reproducible sequence and threads don't contend on a libc lock.
+// Satisfies UniformRandomBitGenerator, so it also works with <random> distributions.
+class Random {
+public:
+  using result_type = uint64_t;
+
+  explicit Random(const uint64_t seed = 42);
+
+  static constexpr result_type min() {
+    return 0;
+  }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()();
+
+  // Uniform integer in [0, bound), bound must be positive
+  size_t UniformIndex(const size_t bound);
+  // Uniform real in [0, 1)
+  double UniformReal();
+  bool Bernoulli(const double probability);
+
+  void Save(SnapshotWriter& writer) const;
+  void Load(SnapshotReader& reader);
+
+  // Fisher-Yates shuffle
+  template <class RandomIt>
+  void Shuffle(RandomIt first, RandomIt last) {
+    const auto size = std::distance(first, last);
+    for (auto i = size - 1; i > 0; --i) {
+      std::iter_swap(first + i, first + UniformIndex(i + 1));
+    }
+  }
+
+private:
+  uint64_t state[4];
+};
@@ -0,0 +1,89 @@
+#include "reservation_table.h"
+
+#include <algorithm>
+
+ReservationTable::ReservationTable(const Graph& graph_)
+  : graph(graph_)
+  , cells_number(graph_.GetCellsNumber()) {}
+
+void ReservationTable::Reserve(const std::vector<Point>& path) {
+  if (path.size() > horizon) {
+    horizon = path.size();
+    reservations.resize(horizon * cells_number, 0);
+  }
+  index_is_valid = false;
+  for (size_t ts = 0; ts < path.size(); ++ts) {
+    uint8_t& entry = reservations[ts * cells_number + graph.GetCellIndex(path[ts])];
+    entry |= kOccupied;
+    reserved_vertices.push_back({graph.GetCellIndex(path[ts]), ts});
+    if (ts > 0 && path[ts - 1] != path[ts]) {
+      entry |= GetDirectionBit(path[ts], path[ts - 1]);
+    }
+  }
+}
+
+bool ReservationTable::IsVertexReserved(const Point& pos, const size_t ts) const {
+  return GetEntry(pos, ts) & kOccupied;
+}
+
+bool ReservationTable::IsEdgeReserved(const Point& from, const Point& to, const size_t ts) const {
+  if (ts == 0 || from == to) {
+    return false;
+  }
+  return GetEntry(from, ts) & GetDirectionBit(from, to);
+}
+
+size_t ReservationTable::GetHorizon() const {
+  return horizon;
+}
+
+std::pair<const uint32_t*, const uint32_t*> ReservationTable::GetReservedTimesteps(
+    const Point& pos) const {
+  if (!index_is_valid) {
+    // Counting sort by cell, paths are reserved in timestep order within themselves only
+    index_offsets.assign(cells_number + 1, 0);
+    for (const auto& [cell, ts] : reserved_vertices) {
+      ++index_offsets[cell + 1];
+    }
+    for (size_t cell = 0; cell < cells_number; ++cell) {
+      index_offsets[cell + 1] += index_offsets[cell];
+    }
+    index_timesteps.resize(reserved_vertices.size());
+    std::vector<uint32_t> positions(index_offsets.begin(), index_offsets.end() - 1);
+    for (const auto& [cell, ts] : reserved_vertices) {
+      index_timesteps[positions[cell]++] = ts;
+    }
+    for (size_t cell = 0; cell < cells_number; ++cell) {
+      if (index_offsets[cell + 1] - index_offsets[cell] > 1) {
+        std::sort(
+            index_timesteps.begin() + index_offsets[cell],
+            index_timesteps.begin() + index_offsets[cell + 1]);
+      }
+    }
+    index_is_valid = true;
+  }
+  const size_t cell = graph.GetCellIndex(pos);
+  return {
+    index_timesteps.data() + index_offsets[cell],
+    index_timesteps.data() + index_offsets[cell + 1]};
+}
+
+uint8_t ReservationTable::GetDirectionBit(const Point& from, const Point& to) const {
+  ASSERT(std::abs(from.x - to.x) + std::abs(from.y - to.y) == 1 && "cells are not adjacent");
+  if (to.x < from.x) {
+    return 1 << 0;
+  } else if (to.x > from.x) {
+    return 1 << 1;
+  } else if (to.y < from.y) {
+    return 1 << 2;
+  } else {
+    return 1 << 3;
+  }
+}
+
+uint8_t ReservationTable::GetEntry(const Point& pos, const size_t ts) const {
+  if (ts >= horizon) {
+    return 0;
+  }
+  return reservations[ts * cells_number + graph.GetCellIndex(pos)];
+}
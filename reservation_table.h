@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.h"
+#include "graph.h"
+
+#include <cstdint>
+#include <vector>
+
+// Space-time occupancy of already planned paths, indexed by (timestep, cell).
+// Every entry stores whether the cell is occupied and which directions it was entered from,
+// so both vertex and edge (swap) conflicts are answered in O(1).
+class ReservationTable {
+public:
+  ReservationTable(const Graph& graph);
+
+  void Reserve(const std::vector<Point>& path);
+
+  bool IsVertexReserved(const Point& pos, const size_t ts) const;
+  // Moving from `from` to `to` at ts swaps places with a path that moves from `to` to `from`
+  bool IsEdgeReserved(const Point& from, const Point& to, const size_t ts) const;
+  // All timesteps starting from the horizon are free
+  size_t GetHorizon() const;
+  // Sorted timesteps at which the cell is occupied, may contain duplicates
+  std::pair<const uint32_t*, const uint32_t*> GetReservedTimesteps(const Point& pos) const;
+
+private:
+  static constexpr uint8_t kOccupied = 1 << 4;
+
+  uint8_t GetDirectionBit(const Point& from, const Point& to) const;
+  uint8_t GetEntry(const Point& pos, const size_t ts) const;
+
+  const Graph& graph;
+  size_t cells_number;
+  size_t horizon = 0;
+  std::vector<uint8_t> reservations;
+  // (cell, timestep) of every reserved vertex and a per-cell index over them,
+  // the index is built on the first GetReservedTimesteps call after a change
+  std::vector<std::pair<uint32_t, uint32_t>> reserved_vertices;
+  mutable bool index_is_valid = false;
+  mutable std::vector<uint32_t> index_offsets;
+  mutable std::vector<uint32_t> index_timesteps;
+};
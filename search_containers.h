@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Open lists for AStar. States are popped by the highest label first, then by the lowest cost,
+// then in insertion order. All of them keep their memory between Clear() calls, so a
+// thread_local instance does not allocate once it has warmed up.
+
+// Dial's bucket queue: one FIFO bucket per (label, cost) pair. Suitable for unit-cost grids
+// where costs are small integers.
+template <typename State>
+class BucketOpenList {
+public:
+  void Clear() {
+    for (size_t label = 0; label < std::min(labels_used, labels.size()); ++label) {
+      auto& label_buckets = labels[label];
+      for (size_t cost = 0; cost < label_buckets.buckets_used; ++cost) {
+        label_buckets.buckets[cost].states.clear();
+        label_buckets.buckets[cost].head = 0;
+      }
+      label_buckets.buckets_used = 0;
+      label_buckets.min_cost = std::numeric_limits<size_t>::max();
+      label_buckets.size = 0;
+    }
+    labels_used = 0;
+    max_label = 0;
+    size = 0;
+  }
+
+  bool Empty() const {
+    return size == 0;
+  }
+
+  void Push(State state, const size_t label, const size_t cost) {
+    if (label >= labels.size()) {
+      labels.resize(label + 1);
+    }
+    labels_used = std::max(labels_used, label + 1);
+    auto& label_buckets = labels[label];
+    if (cost >= label_buckets.buckets.size()) {
+      label_buckets.buckets.resize(cost + 1);
+    }
+    label_buckets.buckets_used = std::max(label_buckets.buckets_used, cost + 1);
+    label_buckets.buckets[cost].states.push_back(std::move(state));
+    label_buckets.min_cost = std::min(label_buckets.min_cost, cost);
+    ++label_buckets.size;
+    max_label = std::max(max_label, label);
+    ++size;
+  }
+
+  State Pop() {
+    while (labels[max_label].size == 0) {
+      --max_label;
+    }
+    auto& label_buckets = labels[max_label];
+    while (label_buckets.buckets[label_buckets.min_cost].Empty()) {
+      ++label_buckets.min_cost;
+    }
+    auto& bucket = label_buckets.buckets[label_buckets.min_cost];
+    State state = std::move(bucket.states[bucket.head]);
+    ++bucket.head;
+    if (bucket.Empty()) {
+      bucket.states.clear();
+      bucket.head = 0;
+    }
+    --label_buckets.size;
+    --size;
+    return state;
+  }
+
+private:
+  struct Bucket {
+    std::vector<State> states;
+    size_t head = 0;
+
+    bool Empty() const {
+      return head == states.size();
+    }
+  };
+
+  struct LabelBuckets {
+    std::vector<Bucket> buckets;
+    size_t buckets_used = 0;
+    size_t min_cost = std::numeric_limits<size_t>::max();
+    size_t size = 0;
+  };
+
+  std::vector<LabelBuckets> labels;
+  size_t labels_used = 0;
+  size_t max_label = 0;
+  size_t size = 0;
+};
+
+// Binary heap ordered by (label, cost, insertion order)
+template <typename State>
+class BinaryHeapOpenList {
+public:
+  void Clear() {
+    heap.clear();
+    inserted = 0;
+  }
+
+  bool Empty() const {
+    return heap.empty();
+  }
+
+  void Push(State state, const size_t label, const size_t cost) {
+    heap.push_back({std::move(state), label, cost, inserted++});
+    std::push_heap(heap.begin(), heap.end(), LowerPriority);
+  }
+
+  State Pop() {
+    std::pop_heap(heap.begin(), heap.end(), LowerPriority);
+    State state = std::move(heap.back().state);
+    heap.pop_back();
+    return state;
+  }
+
+private:
+  struct Entry {
+    State state;
+    size_t label;
+    size_t cost;
+    size_t order;
+  };
+
+  static bool LowerPriority(const Entry& lhs, const Entry& rhs) {
+    if (lhs.label != rhs.label) {
+      return lhs.label < rhs.label;
+    }
+    if (lhs.cost != rhs.cost) {
+      return lhs.cost > rhs.cost;
+    }
+    return lhs.order > rhs.order;
+  }
+
+  std::vector<Entry> heap;
+  size_t inserted = 0;
+};
+
+// Open addressing hash set of 64-bit keys. Clear() is O(1): slots are stamped with
+// the generation they were written in.
+class FlatHashSet {
+public:
+  void Clear() {
+    ++generation;
+    size = 0;
+    if (generation == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      generation = 1;
+    }
+  }
+
+  bool Contains(const uint64_t key) const {
+    if (keys.empty()) {
+      return false;
+    }
+    for (size_t slot = Slot(key); stamps[slot] == generation; slot = (slot + 1) & mask) {
+      if (keys[slot] == key) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Insert(const uint64_t key) {
+    if (2 * (size + 1) > keys.size()) {
+      Grow();
+    }
+    size_t slot = Slot(key);
+    for (; stamps[slot] == generation; slot = (slot + 1) & mask) {
+      if (keys[slot] == key) {
+        return;
+      }
+    }
+    keys[slot] = key;
+    stamps[slot] = generation;
+    ++size;
+  }
+
+private:
+  size_t Slot(const uint64_t key) const {
+    return (key * 0x9E3779B97F4A7C15ull) >> shift;
+  }
+
+  void Grow() {
+    std::vector<uint64_t> old_keys;
+    std::vector<uint32_t> old_stamps;
+    old_keys.swap(keys);
+    old_stamps.swap(stamps);
+    const size_t capacity = std::max<size_t>(1024, 2 * old_keys.size());
+    keys.assign(capacity, 0);
+    stamps.assign(capacity, 0);
+    mask = capacity - 1;
+    shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      --shift;
+    }
+    const uint32_t old_generation = generation;
+    generation = 1;
+    size = 0;
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+      if (old_stamps[i] == old_generation) {
+        Insert(old_keys[i]);
+      }
+    }
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> stamps;
+  uint32_t generation = 1;
+  size_t size = 0;
+  size_t mask = 0;
+  size_t shift = 64;
+};
@@ -0,0 +1,19 @@
+#include "snapshot.h"
+
+#include <cstdio>
+
+SnapshotWriter::SnapshotWriter(const std::string& filename_)
+  : filename(filename_)
+  , tmp_filename(filename_ + ".tmp")
+  , stream(tmp_filename, std::ios::binary) {}
+
+bool SnapshotWriter::Commit() {
+  stream.close();
+  if (stream.fail()) {
+    return false;
+  }
+  return std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
+}
+
+SnapshotReader::SnapshotReader(const std::string& filename)
+  : stream(filename, std::ios::binary) {}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compact binary serialization of the run state. Values are stored in the host byte
+// order, so a snapshot is meant to be resumed on the same kind of machine.
+class SnapshotWriter {
+public:
+  // Everything is written to a temporary file, Commit replaces the target with it
+  SnapshotWriter(const std::string& filename);
+
+  template <class T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written as is");
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  template <class T1, class T2>
+  void Write(const std::pair<T1, T2>& value) {
+    Write(value.first);
+    Write(value.second);
+  }
+  template <class T>
+  void Write(const std::optional<T>& value) {
+    Write(value.has_value());
+    if (value) {
+      Write(value.value());
+    }
+  }
+  template <class T>
+  void Write(const std::vector<T>& values) {
+    WriteRange(values);
+  }
+  template <class T>
+  void Write(const std::deque<T>& values) {
+    WriteRange(values);
+  }
+
+  bool Commit();
+
+private:
+  template <class Container>
+  void WriteRange(const Container& values) {
+    Write(values.size());
+    for (const auto& value : values) {
+      Write(value);
+    }
+  }
+
+  std::string filename;
+  std::string tmp_filename;
+  std::ofstream stream;
+};
+
+class SnapshotReader {
+public:
+  SnapshotReader(const std::string& filename);
+
+  // False once the file is missing, truncated or anything failed to read
+  bool Good() const {
+    return stream.good();
+  }
+
+  template <class T>
+  void Read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read as is");
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+  template <class T1, class T2>
+  void Read(std::pair<T1, T2>& value) {
+    Read(value.first);
+    Read(value.second);
+  }
+  template <class T>
+  void Read(std::optional<T>& value) {
+    bool has_value = false;
+    Read(has_value);
+    value.reset();
+    if (has_value) {
+      value.emplace();
+      Read(value.value());
+    }
+  }
+  template <class T>
+  void Read(std::vector<T>& values) {
+    ReadRange(values);
+  }
+  template <class T>
+  void Read(std::deque<T>& values) {
+    ReadRange(values);
+  }
+
+private:
+  template <class Container>
+  void ReadRange(Container& values) {
+    size_t size = 0;
+    Read(size);
+    values.clear();
+    for (size_t i = 0; i < size && Good(); ++i) {
+      values.emplace_back();
+      Read(values.back());
+    }
+  }
+
+  std::ifstream stream;
+};
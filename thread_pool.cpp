@@ -0,0 +1,118 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+struct WorkerInfo {
+  const ThreadPool* pool = nullptr;
+  size_t idx = 0;
+};
+
+thread_local WorkerInfo current_worker;
+
+}
+
+ThreadPool::ThreadPool(const size_t threads_cnt) {
+  const size_t size = threads_cnt > 0
+      ? threads_cnt
+      : std::max<size_t>(1, std::thread::hardware_concurrency());
+  queues.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  workers.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  has_jobs_cv.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::Size() const {
+  return workers.size();
+}
+
+void ThreadPool::Submit(Job job) {
+  size_t queue_idx;
+  if (current_worker.pool == this) {
+    queue_idx = current_worker.idx;
+  } else {
+    std::lock_guard<std::mutex> lock(mtx);
+    queue_idx = next_queue;
+    next_queue = (next_queue + 1) % queues.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues[queue_idx]->mtx);
+    queues[queue_idx]->jobs.push_back(std::move(job));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    ++unclaimed_jobs;
+    ++unfinished_jobs;
+  }
+  has_jobs_cv.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mtx);
+  all_done_cv.wait(lock, [this] { return unfinished_jobs == 0; });
+}
+
+bool ThreadPool::PopJob(const size_t worker_idx, Job& job) {
+  {
+    auto& own_queue = *queues[worker_idx];
+    std::lock_guard<std::mutex> lock(own_queue.mtx);
+    if (!own_queue.jobs.empty()) {
+      job = std::move(own_queue.jobs.back());
+      own_queue.jobs.pop_back();
+      return true;
+    }
+  }
+  for (size_t shift = 1; shift < queues.size(); ++shift) {
+    auto& victim_queue = *queues[(worker_idx + shift) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim_queue.mtx);
+    if (!victim_queue.jobs.empty()) {
+      job = std::move(victim_queue.jobs.front());
+      victim_queue.jobs.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WorkerLoop(const size_t worker_idx) {
+  current_worker = {this, worker_idx};
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      has_jobs_cv.wait(lock, [this] { return unclaimed_jobs > 0 || stopping; });
+      if (unclaimed_jobs == 0) {
+        return;
+      }
+      // Claiming guarantees that some deque holds a job for this worker
+      --unclaimed_jobs;
+    }
+    Job job;
+    while (!PopJob(worker_idx, job)) {
+      std::this_thread::yield();
+    }
+    job();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      --unfinished_jobs;
+      if (unfinished_jobs == 0) {
+        all_done_cv.notify_all();
+      }
+    }
+  }
+}
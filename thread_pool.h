@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of workers. Every worker owns a deque of jobs: it takes its own jobs
+// from the back and, when the deque is empty, steals from the front of the other ones.
+// Jobs submitted from inside a worker go to that worker's deque, so a job can split
+// itself into smaller jobs that idle workers pick up.
+class ThreadPool {
+public:
+  using Job = std::function<void()>;
+
+  // Zero threads means one per hardware thread
+  ThreadPool(const size_t threads_cnt = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t Size() const;
+  void Submit(Job job);
+  // Blocks until every submitted job, including the ones submitted by jobs, has finished.
+  // Must not be called from a worker.
+  void Wait();
+
+private:
+  struct WorkerQueue {
+    std::deque<Job> jobs;
+    std::mutex mtx;
+  };
+
+  void WorkerLoop(const size_t worker_idx);
+  bool PopJob(const size_t worker_idx, Job& job);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex mtx;
+  std::condition_variable has_jobs_cv;
+  std::condition_variable all_done_cv;
+  // Jobs lying in the deques that no worker has claimed yet
+  size_t unclaimed_jobs = 0;
+  // Jobs that were submitted and haven't finished yet
+  size_t unfinished_jobs = 0;
+  size_t next_queue = 0;
+  bool stopping = false;
+};
@@ -1,32 +1,33 @@
 #include "topsort.h"
 
 #include <algorithm>
-
-namespace {
-
-void DFS(
-    const std::vector<std::vector<size_t>>& priority_graph,
-    std::vector<size_t>& result,
-    std::vector<bool>& used,
-    const size_t v) {
-  used[v] = true;
-  for (size_t u : priority_graph[v]) {
-    if (!used[u]) {
-      DFS(priority_graph, result, used, u);
-    }
-  }
-  result.push_back(v);
-}
-
-}
+#include <cstdint>
+#include <utility>
 
 std::optional<std::vector<size_t>> TopSort(const std::vector<std::vector<size_t>>& priority_graph) {
   std::vector<bool> used(priority_graph.size(), false);
   std::vector<size_t> result;
   result.reserve(priority_graph.size());
+  // Iterative DFS: (vertex, index of the next edge to follow)
+  std::vector<std::pair<size_t, size_t>> stack;
   for (size_t i = 0; i < used.size(); ++i) {
-    if (!used[i]) {
-      DFS(priority_graph, result, used, i);
+    if (used[i]) {
+      continue;
+    }
+    used[i] = true;
+    stack.emplace_back(i, 0);
+    while (!stack.empty()) {
+      auto& [v, edge_idx] = stack.back();
+      if (edge_idx == priority_graph[v].size()) {
+        result.push_back(v);
+        stack.pop_back();
+        continue;
+      }
+      const size_t u = priority_graph[v][edge_idx++];
+      if (!used[u]) {
+        used[u] = true;
+        stack.emplace_back(u, 0);
+      }
     }
   }
   std::reverse(result.begin(), result.end());
@@ -44,4 +45,125 @@ std::optional<std::vector<size_t>> TopSort(const std::vector<std::vector<size_t>
   }
 
   return result;
-}
\ No newline at end of file
+}
+
+IncrementalTopSort::IncrementalTopSort(const size_t size)
+  : order(size)
+  , positions(size) {
+  const auto empty_list = std::make_shared<const std::vector<size_t>>();
+  out_edges.assign(size, empty_list);
+  in_edges.assign(size, empty_list);
+  for (size_t v = 0; v < size; ++v) {
+    order[size - v - 1] = v;
+    positions[v] = size - v - 1;
+  }
+}
+
+IncrementalTopSort::IncrementalTopSort(const std::vector<size_t>& initial_order)
+  : order(initial_order)
+  , positions(initial_order.size()) {
+  const auto empty_list = std::make_shared<const std::vector<size_t>>();
+  out_edges.assign(order.size(), empty_list);
+  in_edges.assign(order.size(), empty_list);
+  for (size_t i = 0; i < order.size(); ++i) {
+    positions[order[i]] = i;
+  }
+}
+
+bool IncrementalTopSort::AddEdge(const size_t from, const size_t to) {
+  if (from == to) {
+    return false;
+  }
+  const size_t lower_bound = positions[to];
+  const size_t upper_bound = positions[from];
+  if (upper_bound < lower_bound) {
+    // Order is already consistent with the new edge
+    AppendEdge(out_edges[from], to);
+    AppendEdge(in_edges[to], from);
+    return true;
+  }
+
+  thread_local std::vector<uint32_t> stamps;
+  thread_local uint32_t stamp = 0;
+  thread_local std::vector<size_t> stack;
+  thread_local std::vector<size_t> forward;
+  thread_local std::vector<size_t> backward;
+  thread_local std::vector<size_t> affected_positions;
+  if (stamps.size() < order.size()) {
+    stamps.resize(order.size(), 0);
+  }
+  ++stamp;
+
+  // Vertices reachable from `to` that are placed not later than `from`
+  forward.clear();
+  stack.assign(1, to);
+  stamps[to] = stamp;
+  while (!stack.empty()) {
+    const size_t v = stack.back();
+    stack.pop_back();
+    forward.push_back(v);
+    for (const size_t u : *out_edges[v]) {
+      if (positions[u] == upper_bound) {
+        // Reached `from`, the edge would close a cycle
+        return false;
+      }
+      if (positions[u] < upper_bound && stamps[u] != stamp) {
+        stamps[u] = stamp;
+        stack.push_back(u);
+      }
+    }
+  }
+
+  // Vertices `from` is reachable from that are placed not earlier than `to`
+  backward.clear();
+  stack.assign(1, from);
+  stamps[from] = stamp;
+  while (!stack.empty()) {
+    const size_t v = stack.back();
+    stack.pop_back();
+    backward.push_back(v);
+    for (const size_t u : *in_edges[v]) {
+      if (positions[u] > lower_bound && stamps[u] != stamp) {
+        stamps[u] = stamp;
+        stack.push_back(u);
+      }
+    }
+  }
+
+  // Reuse the positions of both sets: backward vertices first, then forward ones,
+  // keeping the relative order inside each set
+  const auto by_position = [this] (const size_t lhs, const size_t rhs) {
+    return positions[lhs] < positions[rhs];
+  };
+  std::sort(forward.begin(), forward.end(), by_position);
+  std::sort(backward.begin(), backward.end(), by_position);
+  affected_positions.clear();
+  for (const size_t v : backward) {
+    affected_positions.push_back(positions[v]);
+  }
+  for (const size_t v : forward) {
+    affected_positions.push_back(positions[v]);
+  }
+  std::sort(affected_positions.begin(), affected_positions.end());
+  size_t idx = 0;
+  for (const auto* vertices : {&backward, &forward}) {
+    for (const size_t v : *vertices) {
+      positions[v] = affected_positions[idx++];
+      order[positions[v]] = v;
+    }
+  }
+
+  AppendEdge(out_edges[from], to);
+  AppendEdge(in_edges[to], from);
+  return true;
+}
+
+const std::vector<size_t>& IncrementalTopSort::GetOrder() const {
+  return order;
+}
+
+void IncrementalTopSort::AppendEdge(AdjacencyList& list, const size_t vertex) {
+  auto new_list = std::make_shared<std::vector<size_t>>(*list);
+  new_list->push_back(vertex);
+  list = std::move(new_list);
+}
@@ -1,6 +1,37 @@
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <vector>
 
 std::optional<std::vector<size_t>> TopSort(const std::vector<std::vector<size_t>>& priority_graph);
+
+// Topological order of a DAG that is kept up to date while edges are added, see
+// Pearce & Kelly, "A dynamic topological sort algorithm for directed acyclic graphs".
+// Adding an edge only reorders the vertices between its endpoints. Adjacency lists
+// are shared between copies, so copying costs O(vertices) pointers.
+class IncrementalTopSort {
+public:
+  IncrementalTopSort() = default;
+  // Starts with the order TopSort returns for a graph without edges
+  IncrementalTopSort(const size_t size);
+  // Starts with the given order and no edges
+  IncrementalTopSort(const std::vector<size_t>& initial_order);
+
+  // Adds edge from -> to. Returns false and leaves everything unchanged if it closes a cycle.
+  bool AddEdge(const size_t from, const size_t to);
+
+  const std::vector<size_t>& GetOrder() const;
+
+private:
+  using AdjacencyList = std::shared_ptr<const std::vector<size_t>>;
+
+  static void AppendEdge(AdjacencyList& list, const size_t vertex);
+
+  std::vector<AdjacencyList> out_edges;
+  std::vector<AdjacencyList> in_edges;
+  // position -> vertex
+  std::vector<size_t> order;
+  // vertex -> position
+  std::vector<size_t> positions;
+};